@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_unit.dir/root/repo/src/Test/TestUnit.cpp.o"
+  "CMakeFiles/test_unit.dir/root/repo/src/Test/TestUnit.cpp.o.d"
+  "test_unit"
+  "test_unit.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_unit.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/prj/cmake
+# Build directory: /root/repo/_gate_sse41
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(test_unit "/root/repo/_gate_sse41/test_unit")
+set_tests_properties(test_unit PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/prj/cmake/CMakeLists.txt;139;add_test;/root/repo/prj/cmake/CMakeLists.txt;0;")
@@ -0,0 +1,274 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Synet/Network.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <chrono>
+
+namespace Synet
+{
+    template <class T> class Batcher
+    {
+    public:
+        typedef T Type;
+        typedef Synet::Network<T> Network;
+        typedef typename Network::Tensor Tensor;
+        typedef std::vector<Tensor> Tensors;
+        typedef typename Network::Region Region;
+        typedef typename Network::Regions Regions;
+        typedef std::vector<Type> Vector;
+
+        struct Result
+        {
+            Tensors dst;
+            Regions regions;
+        };
+
+        Batcher()
+            : _topK(0)
+            , _stop(false)
+            , _regions(false)
+            , _threshold(0)
+            , _overlap(0)
+        {
+        }
+
+        ~Batcher()
+        {
+            Stop();
+        }
+
+        bool Init(const Network & network, const Shape & batches, double latency)
+        {
+            Stop();
+            _networks.clear();
+            if (network.Empty() || network.Src().size() != 1 || batches.empty())
+                return false;
+            const Shape shape = network.NchwShape();
+            Shape sorted(batches);
+            std::sort(sorted.begin(), sorted.end());
+            sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+            for (size_t i = 0; i < sorted.size(); ++i)
+            {
+                NetworkPtr net(new Network());
+                if (sorted[i] == 0 || !net->Share(network) || !net->Reshape(shape[3], shape[2], sorted[i]))
+                {
+                    std::cout << "Can't plan network for batch " << sorted[i] << " !" << std::endl;
+                    _networks.clear();
+                    return false;
+                }
+                _networks.push_back(net);
+            }
+            _width = shape[3];
+            _height = shape[2];
+            _size = _networks[0]->Src()[0]->Size(1);
+            _latency = std::chrono::microseconds((int64_t)(latency * 1000000.0));
+            _stop = false;
+            _thread = std::thread(&Batcher::Run, this);
+            return true;
+        }
+
+        void SetRegions(Type threshold, Type overlap, size_t topK = 0)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _regions = true;
+            _threshold = threshold;
+            _overlap = overlap;
+            _topK = topK;
+        }
+
+        size_t MaxBatch() const
+        {
+            return _networks.empty() ? 0 : _networks.back()->Src()[0]->Axis(0);
+        }
+
+        bool Push(const Vector & src, std::future<Result> & result, size_t imageW = 0, size_t imageH = 0)
+        {
+            if (_networks.empty() || src.size() != _size)
+            {
+                std::cout << "Batcher: input size " << src.size() << " doesn't match network input size " << _size << " !" << std::endl;
+                return false;
+            }
+            Request request;
+            request.src = src;
+            request.imageW = imageW ? imageW : _width;
+            request.imageH = imageH ? imageH : _height;
+            request.time = Clock::now();
+            result = request.result.get_future();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_stop)
+                    return false;
+                _queue.push_back(std::move(request));
+            }
+            _cond.notify_one();
+            return true;
+        }
+
+        bool Forward(const Vector & src, Result & result, size_t imageW = 0, size_t imageH = 0)
+        {
+            std::future<Result> future;
+            if (!Push(src, future, imageW, imageH))
+                return false;
+            result = future.get();
+            return true;
+        }
+
+#ifdef SYNET_SIMD_LIBRARY_ENABLE
+        bool Push(const View & view, const Floats & lower, const Floats & upper, std::future<Result> & result, size_t imageW = 0, size_t imageH = 0)
+        {
+            if (_networks.empty())
+                return false;
+            const Shape shape = _networks[0]->NchwShape();
+            if (view.width != shape[3] || view.height != shape[2] || (lower.size() != 1 && lower.size() != shape[1]) || lower.size() != upper.size())
+                return false;
+            Floats l(shape[1], lower[0]), u(shape[1], upper[0]);
+            if (lower.size() > 1)
+                l = lower, u = upper;
+            Vector src(_size);
+            SimdSynetSetInput(view.data, view.width, view.height, view.stride, (SimdPixelFormatType)view.format,
+                l.data(), u.data(), src.data(), shape[1], (SimdTensorFormatType)_networks[0]->Format());
+            return Push(src, result, imageW ? imageW : view.width, imageH ? imageH : view.height);
+        }
+#endif
+
+        void Stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _cond.notify_all();
+            if (_thread.joinable())
+                _thread.join();
+        }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+        typedef std::shared_ptr<Network> NetworkPtr;
+        typedef std::vector<NetworkPtr> NetworkPtrs;
+
+        struct Request
+        {
+            Vector src;
+            size_t imageW, imageH;
+            Clock::time_point time;
+            std::promise<Result> result;
+        };
+        typedef std::vector<Request> Requests;
+
+        void Run()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (true)
+            {
+                _cond.wait(lock, [this] { return _stop || !_queue.empty(); });
+                if (_queue.empty())
+                    return;
+                Clock::time_point deadline = _queue.front().time + _latency;
+                _cond.wait_until(lock, deadline, [this] { return _stop || _queue.size() >= MaxBatch(); });
+                Requests requests;
+                while (requests.size() < MaxBatch() && !_queue.empty())
+                {
+                    requests.push_back(std::move(_queue.front()));
+                    _queue.pop_front();
+                }
+                bool regions = _regions;
+                Type threshold = _threshold, overlap = _overlap;
+                size_t topK = _topK;
+                lock.unlock();
+                Process(requests, regions, threshold, overlap, topK);
+                lock.lock();
+            }
+        }
+
+        void Process(Requests & requests, bool regions, Type threshold, Type overlap, size_t topK)
+        {
+            size_t index = 0;
+            while (_networks[index]->Src()[0]->Axis(0) < requests.size())
+                index++;
+            Network & network = *_networks[index];
+            size_t batch = network.Src()[0]->Axis(0);
+            Type * src = network.Src()[0]->CpuData();
+            for (size_t b = 0; b < batch; ++b, src += _size)
+            {
+                if (b < requests.size())
+                    CpuCopy(requests[b].src.data(), _size, src);
+                else
+                    CpuSet(_size, Type(0), src);
+            }
+            network.Forward();
+            std::vector<Regions> batchRegions;
+            if (regions)
+                batchRegions = network.GetBatchRegions(1, 1, threshold, overlap, topK);
+            for (size_t b = 0; b < requests.size(); ++b)
+            {
+                Result result;
+                for (size_t d = 0; d < network.Dst().size(); ++d)
+                {
+                    const Tensor & dst = *network.Dst()[d];
+                    Shape shape = dst.Shape();
+                    bool batched = shape.size() && shape[0] == batch;
+                    if (batched)
+                        shape[0] = 1;
+                    result.dst.push_back(Tensor());
+                    result.dst.back().Reshape(shape, Type(0), dst.Format());
+                    size_t size = result.dst.back().Size();
+                    CpuCopy(dst.CpuData() + (batched ? b * size : 0), size, result.dst.back().CpuData());
+                }
+                if (regions)
+                {
+                    result.regions = batchRegions[b];
+                    for (size_t i = 0; i < result.regions.size(); ++i)
+                    {
+                        Region & r = result.regions[i];
+                        r.x *= requests[b].imageW;
+                        r.w *= requests[b].imageW;
+                        r.y *= requests[b].imageH;
+                        r.h *= requests[b].imageH;
+                    }
+                }
+                requests[b].result.set_value(std::move(result));
+            }
+        }
+
+        NetworkPtrs _networks;
+        size_t _width, _height, _size, _topK;
+        Clock::duration _latency;
+        bool _stop, _regions;
+        Type _threshold, _overlap;
+        std::deque<Request> _queue;
+        std::mutex _mutex;
+        std::condition_variable _cond;
+        std::thread _thread;
+    };
+}
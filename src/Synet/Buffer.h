@@ -32,6 +32,9 @@ namespace Synet
     {
         SYNET_INLINE void * Allocate(size_t size)
         {
+#ifdef SYNET_ALLOCATION_CHECK
+            CountAllocation();
+#endif
 #ifdef SYNET_SIMD_LIBRARY_ENABLE
             return ::SimdAllocate(size, ::SimdAlignment());
 #else
@@ -41,6 +44,9 @@ namespace Synet
 
         SYNET_INLINE void Free(void * ptr)
         {
+#ifdef SYNET_ALLOCATION_CHECK
+            CountFree();
+#endif
 #ifdef SYNET_SIMD_LIBRARY_ENABLE
             return ::SimdFree(ptr);
 #else
@@ -38,12 +38,14 @@
 
 #define SYNET_MALLOC_TRIM_THRESHOLD 1024*1024
 //#define SYNET_MALLOC_DEBUG
+//#define SYNET_ALLOCATION_CHECK
 
 #define SYNET_INT8_SAFE_ZERO 1
 #define SYNET_INT8_INT16_OWERFLOW
 #define SYNET_INT8_IE_COMPATIBLE 1
 #define SYNET_INT8_INT8_DISABLE
 #define SYNET_INT8_INPUT_ROUND_BUGFIX
+#define SYNET_INT8_TILE_SIZE 4096
 
 #include <stddef.h>
 #include <assert.h>
@@ -79,6 +81,10 @@
 #include <cmath>
 #include <iomanip>
 #include <type_traits>
+#include <limits>
+#ifdef SYNET_ALLOCATION_CHECK
+#include <atomic>
+#endif
 
 #if defined(SYNET_SIMD_LIBRARY_ENABLE)
 #include "Simd/SimdLib.h"
@@ -180,6 +186,15 @@ namespace Synet
         return result;
     }
 
+    namespace Detail
+    {
+        inline size_t & ThreadNumber()
+        {
+            static size_t threadNumber = 1;
+            return threadNumber;
+        }
+    }
+
     inline size_t GetThreadNumber()
     {
 #if defined(SYNET_SIMD_LIBRARY_ENABLE)
@@ -187,7 +202,7 @@ namespace Synet
 #elif defined(SYNET_BLIS_ENABLE)
         return bli_thread_get_num_threads();
 #else
-        return 1;
+        return Detail::ThreadNumber();
 #endif
     }
 
@@ -199,6 +214,7 @@ namespace Synet
 #ifdef SYNET_BLIS_ENABLE
         bli_thread_set_num_threads(threadNumber);
 #endif
+        Detail::ThreadNumber() = std::max<size_t>(threadNumber, 1);
     }
 
     inline bool GetFastMode()
@@ -239,6 +255,54 @@ namespace Synet
 #endif
     }
 
+#ifdef SYNET_ALLOCATION_CHECK
+    namespace Detail
+    {
+        struct AllocationCounter
+        {
+            std::atomic<size_t> allocations, frees;
+        };
+
+        inline AllocationCounter *& ThreadAllocationCounter()
+        {
+            thread_local AllocationCounter * counter = NULL;
+            return counter;
+        }
+
+        SYNET_INLINE void CountAllocation()
+        {
+            AllocationCounter * counter = ThreadAllocationCounter();
+            if (counter)
+                counter->allocations++;
+        }
+
+        SYNET_INLINE void CountFree()
+        {
+            AllocationCounter * counter = ThreadAllocationCounter();
+            if (counter)
+                counter->frees++;
+        }
+
+        class AllocationScope
+        {
+        public:
+            AllocationScope(AllocationCounter * counter)
+                : _previous(ThreadAllocationCounter())
+            {
+                ThreadAllocationCounter() = counter;
+            }
+
+            ~AllocationScope()
+            {
+                ThreadAllocationCounter() = _previous;
+            }
+
+        private:
+            AllocationCounter * _previous;
+        };
+    }
+#endif
+
     template <class T> struct Region
     {
         T x, y, w, h, prob;
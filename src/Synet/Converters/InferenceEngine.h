@@ -27,13 +27,14 @@
 #include "Synet/Common.h"
 #include "Synet/Params.h"
 #include "Synet/Converters/Optimizer.h"
+#include "Synet/Utils/Permute.h"
 
 namespace Synet
 {
     class InferenceEngineToSynet
     {
     public:
-        bool Convert(const String & srcModelPath, const String & srcWeightPath, bool trans, const String & dstModelPath, const String & dstWeightPath)
+        bool Convert(const String & srcModelPath, const String & srcWeightPath, bool trans, const String & dstModelPath, const String & dstWeightPath, bool foldShapes = true)
         {
             if (!Synet::FileExist(srcModelPath))
             {
@@ -67,7 +68,7 @@ namespace Synet
             if (!ConvertNetwork(xml, srcBin, trans, holder(), dstBin))
                 return false;
 
-            Optimizer optimizer;
+            Optimizer optimizer(foldShapes);
             if (!optimizer.Run(holder(), dstBin))
                 return false;
 
@@ -440,44 +441,19 @@ namespace Synet
             StringToValue(pNode->FirstAttribute("size")->Value(), param.size());
             const float * pSrc = srcBin.data() + param.offset() / sizeof(float);
             float * pDst = dstBin.data() + param.offset() / sizeof(float);
-            Tensor dst(pDst, param.size() / sizeof(float), shape, param.format());
             switch (mode)
             {
             case 0:
                 memcpy(pDst, pSrc, param.size());
                 break;
             case 1:
-                for (size_t i = 0; i < shape[0]; ++i)
-                    for (size_t c = 0; c < shape[3]; ++c)
-                        for (size_t y = 0; y < shape[1]; ++y)
-                            for (size_t x = 0; x < shape[2]; ++x)
-                                dst.CpuData(Shape({ i, y, x, c }))[0] = *pSrc++;
+                CpuPermute(pSrc, Shape({ shape[0], shape[3], shape[1], shape[2] }), Shape({ 0, 2, 3, 1 }), pDst);
                 break;
             case 2:
-                for (size_t o = 0; o < shape[3]; ++o)
-                    for (size_t i = 0; i < shape[2]; ++i)
-                        for (size_t y = 0; y < shape[0]; ++y)
-                            for (size_t x = 0; x < shape[1]; ++x)
-                                dst.CpuData(Shape({ y, x, i, o }))[0] = *pSrc++;
+                CpuPermute(pSrc, Shape({ shape[3], shape[2], shape[0], shape[1] }), Shape({ 2, 3, 1, 0 }), pDst);
                 break;
             case 3:
-                for (size_t n = 0; n < shape[0]; n++)
-                {
-                    for (size_t c = 0; c < input[1]; c++)
-                    {
-                        for (size_t y = 0; y < input[2]; y++)
-                        {
-                            for (size_t x = 0; x < input[3]; x++)
-                            {
-                                size_t srcOffset = input[2] * input[3] * c + input[3] * y + x;
-                                size_t dstOffset = input[3] * input[1] * y + input[1] * x + c;
-                                pDst[dstOffset] = pSrc[srcOffset];
-                            }
-                        }
-                    }
-                    pSrc += input[1] * input[2] * input[3];
-                    pDst += input[1] * input[2] * input[3];
-                }
+                CpuPermute(pSrc, Shape({ shape[0], input[1], input[2], input[3] }), Shape({ 0, 2, 3, 1 }), pDst);
                 break;
             default:
                 assert(0);
@@ -1526,9 +1502,9 @@ namespace Synet
         }
     };
 
-    bool ConvertInferenceEngineToSynet(const String & srcData, const String & srcWeights, bool trans, const String & dstXml, const String & dstBin)
+    bool ConvertInferenceEngineToSynet(const String & srcData, const String & srcWeights, bool trans, const String & dstXml, const String & dstBin, bool foldShapes = true)
     {
         InferenceEngineToSynet ieToSynet;
-        return ieToSynet.Convert(srcData, srcWeights, trans, dstXml, dstBin);
+        return ieToSynet.Convert(srcData, srcWeights, trans, dstXml, dstBin, foldShapes);
     }
 }
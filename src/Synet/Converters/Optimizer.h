@@ -26,15 +26,26 @@
 
 #include "Synet/Common.h"
 #include "Synet/Params.h"
+#include "Synet/Network.h"
 
 namespace Synet
 {
     class Optimizer
     {
     public:
+        Optimizer(bool foldShapes = true)
+            : _foldShapes(foldShapes)
+        {
+        }
 
-        bool Run(Synet::NetworkParam & network, const Floats & bin)
+        bool Run(Synet::NetworkParam & network, Floats & bin)
         {
+            if (!RemoveStub(network))
+                return false;
+            if (!RemoveDead(network))
+                return false;
+            if (!FoldConstants(network, bin))
+                return false;
             if (!MergeLayers(network, bin, 0))
                 return false;
             if (!MergeLayers(network, bin, 1))
@@ -51,6 +62,196 @@ namespace Synet
         typedef std::pair<String, String> Change;
         typedef std::vector<Change> Changes;
         typedef std::vector<LayerType> LayerTypes;
+        typedef std::set<String> NameSet;
+
+        bool _foldShapes;
+
+        bool FoldConstants(Synet::NetworkParam & network, Floats & bin)
+        {
+            if (!CanFold(network))
+                return true;
+            LayerParams & layers = network.layers();
+            std::vector<bool> foldable(layers.size(), false);
+            NameSet consts;
+            bool any = false;
+            for (size_t i = 0; i < layers.size(); ++i)
+            {
+                const LayerParam & layer = layers[i];
+                if (layer.type() == LayerTypeConst || (layer.type() == LayerTypeMeta && layer.meta().type() == MetaTypeConst))
+                    consts.insert(layer.dst().begin(), layer.dst().end());
+                else if (IsFoldable(layer, consts))
+                {
+                    foldable[i] = true;
+                    consts.insert(layer.dst()[0]);
+                    any = true;
+                    if (IsShapeDependent(layer))
+                        network.fixedShape() = true;
+                }
+            }
+            if (!any)
+                return true;
+            NameSet outputs = Outputs(network);
+
+            Synet::Network<float> net;
+            Synet::NetworkParamHolder holder;
+            holder() = network;
+            std::stringstream model;
+            if (!holder.Save(model, false))
+                return false;
+            String data = model.str();
+            if (!net.Load(data.c_str(), data.size(), (const char*)bin.data(), bin.size() * sizeof(float)))
+            {
+                std::cout << "Can't load network to fold constant layers!" << std::endl;
+                return false;
+            }
+
+            LayerParams folded;
+            for (size_t i = 0; i < layers.size(); ++i)
+            {
+                if (!foldable[i])
+                {
+                    folded.push_back(layers[i]);
+                    continue;
+                }
+                bool used = false, inner = true;
+                for (size_t j = i + 1; j < layers.size(); ++j)
+                {
+                    for (size_t k = 0; k < layers[j].src().size(); ++k)
+                    {
+                        if (layers[j].src()[k] == layers[i].dst()[0])
+                        {
+                            used = true;
+                            if (!foldable[j])
+                                inner = false;
+                        }
+                    }
+                }
+                if (used && inner)
+                    continue;
+                LayerParam layer;
+                if (!FoldLayer(layers[i], net, bin, layer))
+                    return false;
+                folded.push_back(layer);
+            }
+            NameSet usedBefore, usedAfter;
+            for (size_t i = 0; i < layers.size(); ++i)
+                usedBefore.insert(layers[i].src().begin(), layers[i].src().end());
+            for (size_t i = 0; i < folded.size(); ++i)
+                usedAfter.insert(folded[i].src().begin(), folded[i].src().end());
+            layers.clear();
+            for (size_t i = 0; i < folded.size(); ++i)
+            {
+                const LayerParam & layer = folded[i];
+                bool source = layer.type() == LayerTypeConst || (layer.type() == LayerTypeMeta && layer.meta().type() == MetaTypeConst);
+                if (source && usedBefore.count(layer.dst()[0]) && !usedAfter.count(layer.dst()[0]))
+                    continue;
+                layers.push_back(layer);
+            }
+            if (Outputs(network) != outputs)
+                network.dst() = Strings(outputs.begin(), outputs.end());
+            return RemoveDead(network);
+        }
+
+        bool CanFold(const Synet::NetworkParam & network) const
+        {
+            for (size_t i = 0; i < network.layers().size(); ++i)
+            {
+                const LayerParam & layer = network.layers()[i];
+                if (layer.type() == LayerTypeMeta && (layer.meta().type() == MetaTypeInput || layer.meta().type() == MetaTypeInputWithDefault))
+                    return false;
+                if (layer.type() == LayerTypeInput)
+                {
+                    if (layer.input().shape().empty())
+                        return false;
+                    for (size_t j = 0; j < layer.input().shape().size(); ++j)
+                        for (size_t k = 0; k < layer.input().shape()[j].dim().size(); ++k)
+                            if (layer.input().shape()[j].dim()[k] == (size_t)-1)
+                                return false;
+                }
+                for (size_t j = 0; j < layer.weight().size(); ++j)
+                    if (layer.weight()[j].offset() == (size_t)-1)
+                        return false;
+            }
+            return true;
+        }
+
+        bool IsFoldable(const LayerParam & layer, const NameSet & consts) const
+        {
+            if (layer.dst().size() != 1)
+                return false;
+            switch (layer.type())
+            {
+            case LayerTypePriorBox:
+            case LayerTypePriorBoxClustered:
+            case LayerTypeFill:
+                return _foldShapes;
+            case LayerTypeMeta:
+                switch (layer.meta().type())
+                {
+                case MetaTypeShape:
+                    return _foldShapes;
+                case MetaTypeInput:
+                case MetaTypeInputWithDefault:
+                case MetaTypeStub:
+                case MetaTypeSwitch:
+                case MetaTypeTensorArray:
+                case MetaTypeTensorArrayRead:
+                case MetaTypeTensorArraySize:
+                    return false;
+                default:
+                    for (size_t i = 0; i < layer.src().size(); ++i)
+                        if (consts.find(layer.src()[i]) == consts.end())
+                            return false;
+                    return true;
+                }
+            default:
+                return false;
+            }
+        }
+
+        bool IsShapeDependent(const LayerParam & layer) const
+        {
+            return layer.type() == LayerTypePriorBox || layer.type() == LayerTypePriorBoxClustered || layer.type() == LayerTypeFill ||
+                (layer.type() == LayerTypeMeta && layer.meta().type() == MetaTypeShape);
+        }
+
+        bool FoldLayer(const LayerParam & src, const Synet::Network<float> & net, Floats & bin, LayerParam & dst)
+        {
+            const Synet::Tensor<float> * tensor = net.GetTensor(src.dst()[0]);
+            if (tensor == NULL || tensor->GetType() == TensorTypeUnknown)
+            {
+                std::cout << "Can't fold constant layer " << src.name() << " !" << std::endl;
+                return false;
+            }
+            dst.name() = src.name();
+            dst.dst() = src.dst();
+            if (tensor->GetType() == TensorType32i)
+            {
+                dst.type() = LayerTypeMeta;
+                dst.meta().type() = MetaTypeConst;
+                tensor->Export(dst.meta().alpha());
+            }
+            else if (tensor->GetType() == TensorType32f)
+            {
+                dst.type() = LayerTypeConst;
+                dst.weight().resize(1);
+                WeightParam & weight = dst.weight()[0];
+                weight.dim() = tensor->Shape();
+                weight.format() = tensor->Format() == TensorFormatNhwc ? TensorFormatNhwc : TensorFormatNchw;
+                weight.offset() = bin.size() * sizeof(float);
+                weight.size() = tensor->Size() * sizeof(float);
+                if (src.type() == LayerTypeFill)
+                    bin.resize(bin.size() + tensor->Size(), src.fill().value());
+                else
+                    bin.insert(bin.end(), tensor->CpuData(), tensor->CpuData() + tensor->Size());
+            }
+            else
+            {
+                std::cout << "Can't fold constant layer " << src.name() << " with unsupported type!" << std::endl;
+                return false;
+            }
+            return true;
+        }
 
         bool MergeLayers(Synet::NetworkParam& network, const Floats& bin, int stage)
         {
@@ -106,6 +307,8 @@ namespace Synet
                 }
                 case 1:
                 {
+                    if (MergeConvolutionAndResidual(src, i, dst, changes))
+                        continue;
                     if (MergeConvolutionOrDeconvolutionAndActivation(src, i, dst, changes))
                         continue;
                     break;
@@ -116,9 +319,9 @@ namespace Synet
                         continue;
                     break;
                 }
-                default:
-                    assert(0);
-                    return false;
+                default:
+                    assert(0);
+                    return false;
                 }
                 dst.push_back(src[i]);
             }
@@ -195,6 +398,77 @@ namespace Synet
             return true;
         }
 
+        bool SetActivation(const LayerParam & src, LayerParam & dst)
+        {
+            if (src.type() == LayerTypeRestrictRange)
+            {
+                dst.convolution().activationType() = ActivationFunctionTypeRestrictRange;
+                dst.convolution().activationParam0() = src.restrictRange().lower();
+                dst.convolution().activationParam1() = src.restrictRange().upper();
+                return true;
+            }
+            if (src.type() == LayerTypeRelu)
+            {
+                dst.convolution().activationType() = src.relu().negativeSlope() == 0.0f ? ActivationFunctionTypeRelu : ActivationFunctionTypeLeakyRelu;
+                dst.convolution().activationParam0() = src.relu().negativeSlope();
+                return true;
+            }
+            if (src.type() == LayerTypePrelu)
+            {
+                dst.convolution().activationType() = ActivationFunctionTypePrelu;
+                dst.weight().push_back(src.weight()[0]);
+                return true;
+            }
+            if (src.type() == LayerTypeElu)
+            {
+                dst.convolution().activationType() = ActivationFunctionTypeElu;
+                dst.convolution().activationParam0() = src.elu().alpha();
+                return true;
+            }
+            if (src.type() == LayerTypeHswish)
+            {
+                dst.convolution().activationType() = ActivationFunctionTypeHswish;
+                dst.convolution().activationParam0() = src.hswish().shift();
+                dst.convolution().activationParam1() = src.hswish().scale();
+                return true;
+            }
+            return false;
+        }
+
+        bool MergeConvolutionAndResidual(const LayerParams & src, size_t & index, LayerParams & dst, Changes & changes)
+        {
+            if (index == 0 || dst.empty())
+                return false;
+            const LayerParam & conv = src[index - 1], & sum = src[index];
+            if (conv.type() != LayerTypeConvolution || conv.src().size() != 1 || dst.back().name() != conv.name() ||
+                conv.convolution().activationType() != ActivationFunctionTypeIdentity || conv.convolution().quantizationLevel() == TensorType8i)
+                return false;
+            if (sum.type() == LayerTypeEltwise)
+            {
+                if (sum.eltwise().operation() != EltwiseOperationTypeSum ||
+                    (sum.eltwise().coefficients().size() && sum.eltwise().coefficients() != Floats({ 1.0f, 1.0f })))
+                    return false;
+            }
+            else if (sum.type() != LayerTypeShortcut)
+                return false;
+            if (sum.src().size() != 2)
+                return false;
+            size_t skip = sum.src()[0] == conv.name() ? 1 : 0;
+            if (sum.src()[1 - skip] != conv.name() || sum.src()[skip] == conv.name() || sum.dst()[0] == sum.src()[skip])
+                return false;
+            if (IsUsed(conv.name(), src, index + 1))
+                return false;
+            dst.back().src().push_back(sum.src()[skip]);
+            changes.push_back(Change(sum.name(), conv.name()));
+            if (index + 1 < src.size() && src[index + 1].src().size() == 1 && src[index + 1].src()[0] == sum.name() &&
+                (src[index + 1].dst()[0] == sum.name() || !IsUsed(sum.name(), src, index + 2)) && SetActivation(src[index + 1], dst.back()))
+            {
+                changes.push_back(Change(src[index + 1].name(), conv.name()));
+                index += 1;
+            }
+            return true;
+        }
+
         bool MergeConvolutionOrDeconvolutionAndActivation(const LayerParams & src, size_t index, LayerParams & dst, Changes & changes)
         {
             if (index == 0)
@@ -214,39 +488,7 @@ namespace Synet
                     }
                 }
             }
-            bool result = false;
-            if (src[index].type() == LayerTypeRestrictRange)
-            {
-                dst.back().convolution().activationType() = ActivationFunctionTypeRestrictRange;
-                dst.back().convolution().activationParam0() = src[index].restrictRange().lower();
-                dst.back().convolution().activationParam1() = src[index].restrictRange().upper();
-                result = true;
-            }
-            if (src[index].type() == LayerTypeRelu)
-            {
-                dst.back().convolution().activationType() = src[index].relu().negativeSlope() == 0.0f ? ActivationFunctionTypeRelu : ActivationFunctionTypeLeakyRelu;
-                dst.back().convolution().activationParam0() = src[index].relu().negativeSlope();
-                result = true;
-            }
-            if (src[index].type() == LayerTypePrelu)
-            {
-                dst.back().convolution().activationType() = ActivationFunctionTypePrelu;
-                dst.back().weight().push_back(src[index].weight()[0]);
-                result = true;
-            }
-            if (src[index].type() == LayerTypeElu)
-            {
-                dst.back().convolution().activationType() = ActivationFunctionTypeElu;
-                dst.back().convolution().activationParam0() = src[index].elu().alpha();
-                result = true;
-            }
-            if (src[index].type() == LayerTypeHswish)
-            {
-                dst.back().convolution().activationType() = ActivationFunctionTypeHswish;
-                dst.back().convolution().activationParam0() = src[index].hswish().shift();
-                dst.back().convolution().activationParam1() = src[index].hswish().scale();
-                result = true;
-            }
+            bool result = SetActivation(src[index], dst.back());
             if (result)
             {
                 if (dst.back().convolution().quantizationLevel() == TensorType8i)
@@ -274,6 +516,8 @@ namespace Synet
             if (l0.type() != LayerTypeConvolution || l1.type() != LayerTypeConvolution || 
                 l2.type() != LayerTypeConvolution || l1.src()[0] != l0.dst()[0] || l2.src()[0] != l1.dst()[0])
                 return false;
+            if (l0.src().size() != 1 || l1.src().size() != 1 || (l2.src().size() != 1 && l2.src()[1] != l0.src()[0]))
+                return false;
             if (l0.weight()[0].format() != TensorFormatNhwc)
                 return false;
             if (k0.size() < 2 || (k0[0] != k0[1] || (k0[0] != 1 && k0[0] != 3)))
@@ -299,6 +543,7 @@ namespace Synet
             layer.mergedConvolution().conv().push_back(l0.convolution());
             layer.mergedConvolution().conv().push_back(l1.convolution());
             layer.mergedConvolution().conv().push_back(l2.convolution());
+            layer.mergedConvolution().add() = l2.src().size() > 1;
             index += 2;
             dst.push_back(layer);
             if (src.size() > index + 1)
@@ -995,6 +1240,62 @@ namespace Synet
             return false;
         }
 
+        bool IsUsed(const String & name, const LayerParams & layers, size_t start, size_t end) const
+        {
+            for (size_t i = start; i < end; ++i)
+            {
+                if (std::find(layers[i].src().begin(), layers[i].src().end(), name) != layers[i].src().end())
+                    return true;
+            }
+            return false;
+        }
+
+        size_t Writer(const String & name, const LayerParams & layers, size_t start) const
+        {
+            for (size_t i = start; i < layers.size(); ++i)
+            {
+                if (std::find(layers[i].dst().begin(), layers[i].dst().end(), name) != layers[i].dst().end())
+                    return i;
+            }
+            return layers.size();
+        }
+
+        void Rename(const String & name, const String & unique, LayerParams & layers, size_t start)
+        {
+            std::replace(layers[start].dst().begin(), layers[start].dst().end(), name, unique);
+            for (size_t i = start + 1; i < layers.size(); ++i)
+            {
+                std::replace(layers[i].src().begin(), layers[i].src().end(), name, unique);
+                std::replace(layers[i].dst().begin(), layers[i].dst().end(), name, unique);
+            }
+        }
+
+        String UniqueName(const String & base, const LayerParams & layers) const
+        {
+            String name = base;
+            for (size_t i = 0; IsUsed(name, layers, 0) || Writer(name, layers, 0) < layers.size(); ++i)
+                name = base + "_" + Synet::ValueToString<size_t>(i);
+            return name;
+        }
+
+        size_t UseCount(const String & name, const LayerParams & layers) const
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < layers.size(); ++i)
+                count += std::count(layers[i].src().begin(), layers[i].src().end(), name);
+            return count;
+        }
+
+        size_t Producer(const String & name, const LayerParams & layers, size_t end) const
+        {
+            for (size_t i = 0; i < end; ++i)
+            {
+                if (std::find(layers[i].dst().begin(), layers[i].dst().end(), name) != layers[i].dst().end())
+                    return i;
+            }
+            return end;
+        }
+
         bool CanReuse(const LayerParam & layer)
         {
             if (layer.type() == LayerTypeSigmoid)
@@ -1020,6 +1321,13 @@ namespace Synet
                     continue;
                 if (IsUsed(layer.src()[0], layers, i + 1))
                     continue;
+                if (layer.type() == LayerTypeYolo)
+                {
+                    size_t producer = Producer(layer.src()[0], layers, i);
+                    if (producer < i && layers[producer].type() == LayerTypeConvolution && !Outputs(network).count(layer.src()[0]))
+                        layer.yolo().fused() = true;
+                    continue;
+                }
                 if (!IsUsed(layer.dst()[0], layers, i + 1))
                     continue;
                 if (!CanReuse(layer))
@@ -1030,5 +1338,136 @@ namespace Synet
             }
             return true;
         }
+
+        bool IsOutput(const String & name, const Synet::NetworkParam & network) const
+        {
+            const Strings & dst = network.dst();
+            return std::find(dst.begin(), dst.end(), name) != dst.end();
+        }
+
+        bool IsStub(const LayerParam & layer) const
+        {
+            if (layer.src().size() != 1 || layer.dst().size() != 1)
+                return false;
+            if (layer.type() == LayerTypeStub || layer.type() == LayerTypeDropout)
+                return true;
+            if (layer.type() == LayerTypePermute && layer.permute().format() == TensorFormatUnknown)
+            {
+                const Shape & order = layer.permute().order();
+                for (size_t i = 0; i < order.size(); ++i)
+                    if (order[i] != i)
+                        return false;
+                return true;
+            }
+            return false;
+        }
+
+        bool IsView(const LayerParam & layer) const
+        {
+            if (layer.src().size() != 1 || layer.dst().size() != 1 || layer.src()[0] == layer.dst()[0])
+                return false;
+            return layer.type() == LayerTypeReshape || layer.type() == LayerTypeFlatten || layer.type() == LayerTypeSqueeze;
+        }
+
+        bool IsAbsoluteReshape(const LayerParam & layer) const
+        {
+            if (layer.type() != LayerTypeReshape || layer.src().size() != 1)
+                return false;
+            const ReshapeParam & reshape = layer.reshape();
+            if (reshape.axis() != 0 || reshape.numAxes() != -1)
+                return false;
+            for (size_t i = 0; i < reshape.shape().size(); ++i)
+                if (reshape.shape()[i] == 0)
+                    return false;
+            return true;
+        }
+
+        bool RemoveStub(Synet::NetworkParam & network)
+        {
+            LayerParams & layers = network.layers();
+            for (size_t i = 0; i < layers.size(); ++i)
+            {
+                const LayerParam & layer = layers[i];
+                if (IsStub(layer))
+                {
+                    const String src = layer.src()[0], dst = layer.dst()[0];
+                    if (src != dst && (!IsUsed(dst, layers, i + 1) || IsOutput(dst, network)))
+                        continue;
+                    size_t end = std::min(Writer(dst, layers, i + 1) + 1, layers.size());
+                    size_t writer = Writer(src, layers, i + 1);
+                    if (src != dst && writer + 1 < end && IsUsed(dst, layers, writer + 1, end))
+                    {
+                        if (Outputs(network).count(src))
+                            continue;
+                        Rename(src, UniqueName(layers[writer].name(), layers), layers, writer);
+                    }
+                    for (size_t j = i + 1; j < end; ++j)
+                        std::replace(layers[j].src().begin(), layers[j].src().end(), dst, src);
+                    layers.erase(layers.begin() + i);
+                    i--;
+                }
+                else if (IsAbsoluteReshape(layer))
+                {
+                    for (size_t p = Producer(layer.src()[0], layers, i); p < i; p = Producer(layers[i].src()[0], layers, i))
+                    {
+                        const String & src = layers[i].src()[0];
+                        if (!IsView(layers[p]) || IsOutput(src, network) || UseCount(src, layers) != 1)
+                            break;
+                        layers[i].src()[0] = layers[p].src()[0];
+                        layers.erase(layers.begin() + p);
+                        i--;
+                    }
+                }
+            }
+            return true;
+        }
+
+        NameSet Outputs(const Synet::NetworkParam & network) const
+        {
+            const LayerParams & layers = network.layers();
+            NameSet outputs;
+            if (network.dst().size())
+                outputs.insert(network.dst().begin(), network.dst().end());
+            else
+            {
+                std::map<String, bool> available;
+                for (size_t i = 0; i < layers.size(); ++i)
+                {
+                    for (size_t j = 0; j < layers[i].src().size(); ++j)
+                        available.erase(layers[i].src()[j]);
+                    for (size_t j = 0; j < layers[i].dst().size(); ++j)
+                        available[layers[i].dst()[j]] = layers[i].type() != LayerTypeMeta;
+                }
+                for (std::map<String, bool>::const_iterator it = available.begin(); it != available.end(); ++it)
+                    if (it->second)
+                        outputs.insert(it->first);
+            }
+            return outputs;
+        }
+
+        bool RemoveDead(Synet::NetworkParam & network)
+        {
+            LayerParams & layers = network.layers();
+            NameSet outputs = Outputs(network), used;
+            for (ptrdiff_t i = layers.size() - 1; i >= 0; --i)
+            {
+                const LayerParam & layer = layers[i];
+                bool dead = layer.type() != LayerTypeInput && !(layer.type() == LayerTypeMeta &&
+                    (layer.meta().type() == MetaTypeInput || layer.meta().type() == MetaTypeInputWithDefault));
+                for (size_t j = 0; j < layer.dst().size() && dead; ++j)
+                {
+                    const String & dst = layer.dst()[j];
+                    if (used.find(dst) != used.end() || outputs.find(dst) != outputs.end())
+                        dead = false;
+                    if (std::find(layer.src().begin(), layer.src().end(), dst) != layer.src().end())
+                        dead = false;
+                }
+                if (dead)
+                    layers.erase(layers.begin() + i);
+                else
+                    used.insert(layer.src().begin(), layer.src().end());
+            }
+            return true;
+        }
     };
 }
\ No newline at end of file
@@ -69,7 +69,7 @@ namespace Synet
             return 0;
         }
 
-        virtual void CompactWeight()
+        virtual void CompactWeight(bool keepSource)
         {
         }
 
@@ -83,6 +83,20 @@ namespace Synet
             return false;
         }
 
+        virtual Ints Algorithms() const
+        {
+            return Ints();
+        }
+
+        virtual void SetAlgorithm(int algorithm)
+        {
+        }
+
+        virtual String TuningKey() const
+        {
+            return String();
+        }
+
         virtual void DebugPrint(std::ostream & os, int flag, int first, int last, int precision)
         {
         }
@@ -154,7 +168,7 @@ namespace Synet
             return true;
         }
 
-        bool Load(const char * & data, size_t & size, const LayerSharedPtrs & layers)
+        bool Load(const char * & data, size_t & size, const LayerSharedPtrs & layers, bool map = false)
         {
             _weight.resize(_param.weight().size());
             for (size_t i = 0; i < _weight.size(); ++i)
@@ -165,11 +179,10 @@ namespace Synet
                 ptrdiff_t length = param.size();
                 if (offset < 0 && length < 0)
                 {
-                    tensor.Reshape(param.dim(), Type(), param.format());
-                    length = tensor.Size() * sizeof(T);
+                    length = Detail::Size(param.dim()) * sizeof(T);
                     if (length > size)
                         return false;
-                    memcpy((char*)tensor.CpuData(), data, length);
+                    Load(tensor, param, data, length, map);
                     data += length;
                     size -= length;
                 }
@@ -193,14 +206,27 @@ namespace Synet
                     {
                         if (offset + length > size)
                             return false;
-                        tensor.Reshape(param.dim(), Type(), param.format());
-                        memcpy((char*)tensor.CpuData(), data + offset, length);
+                        Load(tensor, param, data + offset, length, map);
                     }
                 }
             }
             return true;
         }
 
+        virtual bool Share(const Layer & layer)
+        {
+            if (&layer._param != &_param)
+                return false;
+            _weight.resize(layer._weight.size());
+            for (size_t i = 0; i < _weight.size(); ++i)
+            {
+                if (layer._weight[i].Shape() != _param.weight()[i].dim())
+                    return false;
+                _weight[i].Share(layer._weight[i]);
+            }
+            return true;
+        }
+
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst) = 0;
 
@@ -227,6 +253,18 @@ namespace Synet
         SYNET_PERF_DECL(_perfComm);
         SYNET_PERF_DECL(_perfSpec);
 
+        static void Load(Tensor & tensor, const WeightParam & param, const char * data, size_t length, bool map)
+        {
+            size_t size = Detail::Size(param.dim());
+            if (map && size * sizeof(T) == length && size_t(data) % sizeof(T) == 0)
+                tensor.ShareAs((const Type*)data, size, param.dim(), param.format());
+            else
+            {
+                tensor.Reshape(param.dim(), Type(), param.format());
+                memcpy((char*)tensor.CpuData(), data, length);
+            }
+        }
+
         bool SetStats(const StatSharedPtrs & src, const Strings & names, StatPtrs & dst)
         {
             dst.clear();
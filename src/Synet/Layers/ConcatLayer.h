@@ -91,41 +91,34 @@ namespace Synet
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
-            if (src.size() == 1)
+            if (src.size() == 1 || InPlace(src, dst))
                 return;
 
             switch (_type)
             {
-            case TensorType32f: 
-            {
-                std::vector<float*> pSrc(src.size());
-                for (size_t i = 0; i < src.size(); ++i)
-                    pSrc[i] = src[i]->As32f().CpuData();
-                ForwardCpu(pSrc, dst[0]->As32f().CpuData());
-                break;
-            }
-            case TensorType8u:
-            {
-                std::vector<uint8_t*> pSrc(src.size());
-                for (size_t i = 0; i < src.size(); ++i)
-                    pSrc[i] = src[i]->As8u().CpuData();
-                ForwardCpu(pSrc, dst[0]->As8u().CpuData());
-                break;
-            }
-            case TensorType8i:
-            {
-                std::vector<int8_t*> pSrc(src.size());
-                for (size_t i = 0; i < src.size(); ++i)
-                    pSrc[i] = src[i]->As8i().CpuData();
-                ForwardCpu(pSrc, dst[0]->As8i().CpuData());
-                break;
-            }
+            case TensorType32f: ForwardCpu(src, dst[0]->As32f().CpuData()); break;
+            case TensorType8u: ForwardCpu(src, dst[0]->As8u().CpuData()); break;
+            case TensorType8i: ForwardCpu(src, dst[0]->As8i().CpuData()); break;
             default:
                 assert(0);
             }
         }
 
-        template <class TT> void ForwardCpu(std::vector<TT*> src, TT * dst)
+        bool InPlace(const TensorPtrs & src, const TensorPtrs & dst) const
+        {
+            if (_concatNum != 1)
+                return false;
+            const uint8_t * data = (const uint8_t*)dst[0]->RawData();
+            for (size_t i = 0; i < src.size(); ++i)
+            {
+                if (src[i]->RawData() != data)
+                    return false;
+                data += src[i]->Size() * Detail::TensorTypeSize(src[i]->GetType());
+            }
+            return true;
+        }
+
+        template <class TT> void ForwardCpu(const TensorPtrs & src, TT * dst)
         {
             if (_concatInputSize == 1)
             {
@@ -134,8 +127,7 @@ namespace Synet
                     for (size_t i = 0; i < src.size(); ++i)
                     {
                         size_t size = _srcConcatAxis[i];
-                        CpuCopy(src[i], size, dst);
-                        src[i] += size;
+                        CpuCopy((const TT*)src[i]->RawData() + n * size, size, dst);
                         dst += size;
                     }
                 }
@@ -146,7 +138,7 @@ namespace Synet
                 for (size_t i = 0; i < src.size(); ++i)
                 {
                     for (size_t n = 0; n < _concatNum; ++n)
-                        CpuCopy(src[i] + n * _srcConcatAxis[i] * _concatInputSize, _srcConcatAxis[i] * _concatInputSize,
+                        CpuCopy((const TT*)src[i]->RawData() + n * _srcConcatAxis[i] * _concatInputSize, _srcConcatAxis[i] * _concatInputSize,
                             dst + (n * _dstConcatAxis + concatAxisOffset) * _concatInputSize);
                     concatAxisOffset += _srcConcatAxis[i];
                 }
@@ -31,12 +31,109 @@
 #include "Synet/Utils/Winograd.h"
 #include "Synet/Utils/Convolution.h"
 #include "Synet/Utils/Activation.h"
+#include "Synet/Utils/Parallel.h"
 #include "Synet/Layers/PreluLayer.h"
 #include "Synet/Layers/ScaleLayer.h"
 #include "Synet/Layers/HswishLayer.h"
 
 namespace Synet
 {
+    namespace Detail
+    {
+        SYNET_INLINE void ConvolutionRange(size_t src, size_t pad, size_t stride, size_t offset, size_t dst, size_t & begin, size_t & end)
+        {
+            begin = offset < pad ? std::min((pad - offset + stride - 1) / stride, dst) : 0;
+            end = src + pad > offset ? std::min((src + pad - offset + stride - 1) / stride, dst) : 0;
+            end = std::max(begin, end);
+        }
+
+        template<class T, size_t K> void ConvolutionDepthwiseNchw(const T * src, const ConvParam & conv, const T * weight, const T * bias, T * dst)
+        {
+            const size_t kY = K ? K : conv.kernelY, kX = K ? K : conv.kernelX, sX = conv.strideX, dX = conv.dilationX;
+            const size_t srcH = conv.srcH, srcW = conv.srcW, dstH = conv.dstH, dstW = conv.dstW;
+            ParallelFor(0, conv.dstC, [&](size_t begin, size_t end)
+            {
+                for (size_t c = begin; c < end; ++c)
+                {
+                    const T * ps = src + c * srcH * srcW;
+                    const T * pw = weight + c * kY * kX;
+                    T * pd = dst + c * dstH * dstW;
+                    T b = bias ? bias[c] : T(0);
+                    for (size_t dy = 0; dy < dstH; ++dy, pd += dstW)
+                    {
+                        for (size_t dx = 0; dx < dstW; ++dx)
+                            pd[dx] = b;
+                        for (size_t ky = 0; ky < kY; ++ky)
+                        {
+                            size_t sy = dy * conv.strideY + ky * conv.dilationY - conv.padY;
+                            if (sy >= srcH)
+                                continue;
+                            for (size_t kx = 0; kx < kX; ++kx)
+                            {
+                                size_t xBeg, xEnd;
+                                ConvolutionRange(srcW, conv.padX, sX, kx * dX, dstW, xBeg, xEnd);
+                                if (xBeg == xEnd)
+                                    continue;
+                                const T w = pw[ky * kX + kx];
+                                const T * s = ps + sy * srcW + xBeg * sX + kx * dX - conv.padX;
+                                T * d = pd + xBeg;
+                                size_t size = xEnd - xBeg;
+                                if (sX == 1)
+                                {
+                                    for (size_t i = 0; i < size; ++i)
+                                        d[i] += s[i] * w;
+                                }
+                                else
+                                {
+                                    for (size_t i = 0; i < size; ++i)
+                                        d[i] += s[i * sX] * w;
+                                }
+                            }
+                        }
+                    }
+                }
+            }, ParallelGrain(dstH * dstW * kY * kX));
+        }
+
+        template<class T, size_t K> void ConvolutionDepthwiseNhwc(const T * src, const ConvParam & conv, const T * weight, const T * bias, T * dst)
+        {
+            const size_t kY = K ? K : conv.kernelY, kX = K ? K : conv.kernelX, dY = conv.dilationY, dX = conv.dilationX;
+            const size_t srcH = conv.srcH, srcW = conv.srcW, dstW = conv.dstW, C = conv.dstC;
+            ParallelFor(0, conv.dstH, [&](size_t begin, size_t end)
+            {
+                T * pd = dst + begin * dstW * C;
+                for (size_t dy = begin; dy < end; ++dy)
+                {
+                    size_t sy0 = dy * conv.strideY - conv.padY;
+                    for (size_t dx = 0; dx < dstW; ++dx, pd += C)
+                    {
+                        size_t sx0 = dx * conv.strideX - conv.padX;
+                        if (bias)
+                            memcpy(pd, bias, C * sizeof(T));
+                        else
+                            memset(pd, 0, C * sizeof(T));
+                        for (size_t ky = 0; ky < kY; ++ky)
+                        {
+                            size_t sy = sy0 + ky * dY;
+                            if (sy >= srcH)
+                                continue;
+                            for (size_t kx = 0; kx < kX; ++kx)
+                            {
+                                size_t sx = sx0 + kx * dX;
+                                if (sx >= srcW)
+                                    continue;
+                                const T * ps = src + (sy * srcW + sx) * C;
+                                const T * pw = weight + (ky * kX + kx) * C;
+                                for (size_t c = 0; c < C; ++c)
+                                    pd[c] += ps[c] * pw[c];
+                            }
+                        }
+                    }
+                }
+            }, ParallelGrain(dstW * C * kY * kX));
+        }
+    }
+
     template <class T> class ConvolutionLayer : public Synet::Layer<T>
     {
     public:
@@ -45,6 +142,16 @@ namespace Synet
         typedef typename Base::Tensor Tensor;
         typedef std::vector<Tensor> Tensors;
         typedef typename Base::TensorPtrs TensorPtrs;
+        typedef void(*DepthwisePtr)(const T * src, const ConvParam & conv, const T * weight, const T * bias, T * dst);
+
+        enum Algorithm
+        {
+            AlgorithmAuto = -1,
+            AlgorithmGemm,
+            AlgorithmWinograd2x3,
+            AlgorithmWinograd4x3,
+            AlgorithmDepthwise,
+        };
 
         ConvolutionLayer(const LayerParam & param)
             : Base(param)
@@ -54,17 +161,44 @@ namespace Synet
             _src8u = false;
             _dst8u = false;
             _internal = 0;
+            _sharedP = false;
+            _sharedW = false;
+            _depthwise = NULL;
+            _algorithm = AlgorithmAuto;
         }
 
         virtual size_t MemoryUsage() const
         {
-            return Base::MemoryUsage() + _convolution32f.InternalBufferSize() * sizeof(Type);
+            return Base::MemoryUsage() + (_convolution32f.InternalBufferSize() + (_sharedP ? 0 : _weightP.Size()) + (_sharedW ? 0 : _winograd.FilterSize())) * sizeof(Type);
         }
 
-        virtual void CompactWeight()
+        virtual void CompactWeight(bool keepSource)
         {
             if (_internal)
                 ((Tensor&)this->Weight()[0]).Clear();
+            else if (!keepSource && _depthwise == NULL && (_winograd.Enable() || _weightP.Size()))
+            {
+                _algorithm = _winograd.Enable() ? (_winograd.Block() == 2 ? AlgorithmWinograd2x3 : AlgorithmWinograd4x3) : AlgorithmGemm;
+                ((Tensor&)this->Weight()[0]).Clear();
+            }
+        }
+
+        // Shared packed weights are never rewritten in place: every repacking (tuning, reshape) starts from a cleared
+        // tensor with a fresh buffer, so the owner and the sharing contexts can change algorithms independently.
+        virtual bool Share(const Base & layer)
+        {
+            const ConvolutionLayer & conv = (const ConvolutionLayer &)layer;
+            _weight8i.Share(conv._weight8i);
+            _weight8iP.Share(conv._weight8iP);
+            _norm32i.Share(conv._norm32i);
+            _norm32f.Share(conv._norm32f);
+            _weightP.Share(conv._weightP);
+            _sharedP = _weightP.Size() != 0;
+            _winograd.Share(conv._winograd);
+            _sharedW = _winograd.FilterSize() != 0;
+            if (conv.Weight()[0].Size() == 0)
+                _algorithm = conv._algorithm;
+            return Base::Share(layer);
         }
 
         virtual bool Can8i() const
@@ -77,9 +211,29 @@ namespace Synet
             return _is8i;
         }
 
+        virtual Ints Algorithms() const
+        {
+            return this->Weight()[0].Size() ? _algorithms : Ints();
+        }
+
+        virtual void SetAlgorithm(int algorithm)
+        {
+            _algorithm = algorithm;
+        }
+
+        virtual String TuningKey() const
+        {
+            std::stringstream key;
+            key << "n=" << _num << " i=" << _conv.srcC << "x" << _conv.srcH << "x" << _conv.srcW << " o=" << _conv.dstC;
+            key << " k=" << _conv.kernelY << "x" << _conv.kernelX << " s=" << _conv.strideY << "x" << _conv.strideX;
+            key << " d=" << _conv.dilationY << "x" << _conv.dilationX << " p=" << _conv.padY << "," << _conv.padX << "," << _conv.padH << "," << _conv.padW;
+            key << " g=" << _conv.group << " f=" << (_trans ? "nhwc" : "nchw");
+            return key.str();
+        }
+
         virtual void Reshape(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
-            assert(src.size() == 1);
+            assert(src.size() == 1 || src.size() == 2);
 
             const ConvolutionParam & param = this->Param().convolution();
             const Tensors & weight = this->Weight();
@@ -88,6 +242,7 @@ namespace Synet
             _conv.Set(*src[0], true);
 
             _is1x1 = _conv.Is1x1();
+            _add = src.size() > 1;
             _biasTerm = param.biasTerm();
             if (_biasTerm)
                 assert(weight[1].Size() == _conv.dstC);
@@ -112,7 +267,7 @@ namespace Synet
 
             _num = src[0]->Size(0, _axis);
             _trans = src[0]->Format() == TensorFormatNhwc;
-            assert(weight[0].Shape() == _conv.WeightShape(_trans != 0, true) && weight[0].Format() == src[0]->Format());
+            assert(weight[0].Size() == 0 || (weight[0].Shape() == _conv.WeightShape(_trans != 0, true) && weight[0].Format() == src[0]->Format()));
 
             Shape dstShape(src[0]->Shape().begin(), src[0]->Shape().begin() + _axis);
             if (_trans)
@@ -154,23 +309,49 @@ namespace Synet
 
             if (_is8i)
             {
+                assert(!_add);
                 _src8u = src[0]->GetType() == TensorType8u;
                 _dst8u = dst[0]->GetType() == TensorType8u;
                 if (!_src8u)
                     buf[TensorType8u*BUFFER_COUNT + 1]->As8u().Extend(src[0]->Shape());
                 buf[TensorType8u*BUFFER_COUNT]->As8u().Extend(Shape({ _conv.kernelY * _conv.kernelX * _conv.srcC * _conv.dstH * _conv.dstW }));
-                buf[TensorType32i*BUFFER_COUNT]->As32i().Extend(dstShape, src[0]->Format());
+                if (_conv.group == 1)
+                {
+                    size_t rows = _trans ? _siS : _conv.dstC;
+                    _tile8i = std::min(rows, std::max<size_t>(Detail::GEMM8I_MR * 4, SYNET_INT8_TILE_SIZE / _ldD));
+                    CpuGemm8iOrder(_conv.kernelY * _conv.kernelX, _conv.srcC, _trans != 0, _order8i);
+                    _direct8i = CpuGemm8iOrderIsIdentity(_order8i);
+                    size_t Q4 = _order8i.size(), size = _tile8i * _ldD;
+                    if (_trans)
+                        size += (_tile8i * Q4 + 3) / 4;
+                    else
+                    {
+                        const size_t NR = Detail::GEMM8I_NR;
+                        _cols8i = (std::min(_siS, std::max(NR * 4, SYNET_INT8_TILE_SIZE / _conv.dstC)) + NR - 1) / NR * NR;
+                        size = std::max(size, _conv.dstC * _cols8i) + CpuGemm8iPackedSizeB(_cols8i, Q4 / 4) / 4;
+                    }
+                    buf[TensorType32i*BUFFER_COUNT]->As32i().Extend(Shape({ size }));
+                }
+                else
+                    buf[TensorType32i*BUFFER_COUNT]->As32i().Extend(Shape({ _conv.dstC * _conv.dstH * _conv.dstW }));
                 if(_dst8u)
                     dst[0]->As8u().Reshape(dstShape, src[0]->Format());
                 else
                     dst[0]->As32f().Reshape(dstShape, src[0]->Format());
                 Init8i();
+                if (_conv.group == 1 && _weight8iP.Size() == 0 && Packed8i())
+                    PackWeight8i();
             }
             else
             {
                 dst[0]->Reshape(dstShape, src[0]->Format());
+                if (_add)
+                    assert(src[1]->Shape() == dstShape);
 
-                _convolution32f.Init(_num, &_conv, SYNET_EXTERNAL_GEMM);
+                ConvParam conv = _conv;
+                if (_add)
+                    conv.activation = ActivationFunctionTypeIdentity;
+                _convolution32f.Init(_num, &conv, SYNET_EXTERNAL_GEMM);
                 if (_convolution32f.Enable())
                 {
                     buf[TensorType32f*BUFFER_COUNT]->Extend({ _convolution32f.ExternalBufferSize() });
@@ -178,7 +359,71 @@ namespace Synet
                         _conv.activation == ActivationFunctionTypePrelu ? weight.back().CpuData() : _params);
                 }
                 else
-                    buf[TensorType32f*BUFFER_COUNT]->Extend(Shape({ _conv.kernelY * _conv.kernelX * _conv.srcC, _conv.dstH * _conv.dstW }));
+                {
+                    _depthwise = NULL;
+                    _algorithms.clear();
+                    if (_conv.IsDepthwise())
+                    {
+                        _algorithms.push_back(AlgorithmDepthwise);
+                        _algorithms.push_back(AlgorithmGemm);
+                        if (_algorithm != AlgorithmGemm)
+                        {
+                            if (_conv.kernelY == 3 && _conv.kernelX == 3)
+                                _depthwise = _trans ? Detail::ConvolutionDepthwiseNhwc<T, 3> : Detail::ConvolutionDepthwiseNchw<T, 3>;
+                            else if (_conv.kernelY == 5 && _conv.kernelX == 5)
+                                _depthwise = _trans ? Detail::ConvolutionDepthwiseNhwc<T, 5> : Detail::ConvolutionDepthwiseNchw<T, 5>;
+                            else
+                                _depthwise = _trans ? Detail::ConvolutionDepthwiseNhwc<T, 0> : Detail::ConvolutionDepthwiseNchw<T, 0>;
+                        }
+                    }
+                    else if (!_trans)
+                    {
+                        InitWinograd(2);
+                        if (_winograd.Enable())
+                        {
+                            _algorithms.push_back(AlgorithmGemm);
+                            _algorithms.push_back(AlgorithmWinograd2x3);
+                        }
+                        InitWinograd(4);
+                        if (_winograd.Enable())
+                            _algorithms.push_back(AlgorithmWinograd4x3);
+                        InitWinograd(_algorithm == AlgorithmWinograd2x3 ? 2 : (_algorithm == AlgorithmWinograd4x3 ? 4 : (_algorithm == AlgorithmGemm ? 1 : 0)));
+                    }
+                    if (_depthwise == NULL)
+                    {
+                        if (_winograd.Enable())
+                        {
+                            buf[TensorType32f*BUFFER_COUNT + 0]->Extend(Shape({ _winograd.SrcBufSize() }));
+                            buf[TensorType32f*BUFFER_COUNT + 1]->Extend(Shape({ _winograd.DstBufSize() }));
+                            if (_sharedW && !_winograd.HasFilter())
+                            {
+                                _winograd.Clear();
+                                _sharedW = false;
+                            }
+                            _winograd.SetFilter(weight[0].CpuData());
+                            if (!_sharedP)
+                                _weightP.Clear();
+                        }
+                        else
+                        {
+                            if (!_sharedW)
+                                _winograd.Clear();
+                            if (!_is1x1)
+                            {
+                                buf[TensorType32f*BUFFER_COUNT]->Extend(Shape({ _conv.kernelY * _conv.kernelX * _conv.srcC, _conv.dstH * _conv.dstW }));
+                                _zero.Reshape({ _conv.srcC }, Type(0));
+                            }
+                            PackWeight();
+                        }
+                    }
+                    else
+                    {
+                        if (!_sharedP)
+                            _weightP.Clear();
+                        if (!_sharedW)
+                            _winograd.Clear();
+                    }
+                }
             }
             _srcSize = src[0]->Size(_axis);
             _dstSize = dst[0]->Size(_axis);
@@ -218,80 +463,174 @@ namespace Synet
                 int32_t * sum = buf[TensorType32i*BUFFER_COUNT]->As32i().CpuData();
                 if (!_src8u)
                     Convert32fTo8u(src[0]->As32f().CpuData(), _srcCvt, tmp);
-                ForwardCpu8i(tmp, buf0, sum);
-                if(_dst8u)
-                    Convert32iTo8u(sum, _dstCvt, dst[0]->As8u().CpuData());
+                if (_dst8u)
+                    ForwardCpu8i(tmp, buf0, sum, dst[0]->As8u().CpuData());
                 else
-                    Convert32iTo32f(sum, _dstCvt, dst[0]->As32f().CpuData());
+                    ForwardCpu8i(tmp, buf0, sum, dst[0]->As32f().CpuData());
             }
             else
-                ForwardCpu(src[0]->CpuData(), buf[TensorType32f*BUFFER_COUNT]->CpuData(), dst[0]->CpuData());
+                ForwardCpu(src[0]->CpuData(), _add ? src[1]->CpuData() : NULL, buf[TensorType32f*BUFFER_COUNT + 0]->CpuData(), 
+                    buf[TensorType32f*BUFFER_COUNT + 1]->CpuData(), dst[0]->CpuData());
         }
 
-        void ForwardCpu(const T * src, T * buf, T * dst)
+        void ForwardCpu(const T * src, const T * add, T * buf0, T * buf1, T * dst)
         {
             if (_convolution32f.Enable())
-                _convolution32f.Forward(src, buf, dst);
+            {
+                _convolution32f.Forward(src, buf0, dst);
+                for (size_t n = 0; add && n < _num; ++n)
+                {
+                    Epilogue(NULL, add, 0, _trans ? _conv.dstH * _conv.dstW : _conv.dstC, _ldD, dst);
+                    add += _dstSize;
+                    dst += _dstSize;
+                }
+            }
             else
             {
-                const Type * weight = this->Weight()[0].CpuData();
                 for (size_t n = 0; n < _num; ++n)
                 {
-                    const Type * tmp = src;
-                    if (!_is1x1)
+                    const Type * bias = _biasTerm ? this->Weight()[1].CpuData() : NULL;
+                    if (_depthwise)
                     {
-                        if (_trans)
-                            Synet::ImgToRow(tmp, _conv.srcH, _conv.srcW, _conv.srcC, _conv.kernelY, _conv.kernelX, 
-                                _conv.padY, _conv.padX, _conv.padH, _conv.padW, _conv.strideY, _conv.strideX, _conv.dilationY, _conv.dilationX, _conv.group, (const Type*)NULL, buf);
-                        else
-                            Synet::ImgToCol(tmp, _conv.srcC, _conv.srcH, _conv.srcW, _conv.kernelY, _conv.kernelX, 
-                                _conv.padY, _conv.padX, _conv.padH, _conv.padW, _conv.strideY, _conv.strideX, _conv.dilationY, _conv.dilationX, (const Type*)NULL, buf);
-                        tmp = buf;
-                    }
-                    if (_trans)
-                    {
-                        assert(_conv.group == 1 || _conv.group == _conv.srcC);
-                        for (size_t g = 0; g < _conv.group; ++g)
-                            CpuGemm(CblasNoTrans, CblasNoTrans, _siS, _siD, _siW, Type(1), tmp + _grS * g, _ldS, weight + _grW * g, _ldW, Type(0), dst + _grD * g, _ldD);
+                        _depthwise(src, _conv, this->Weight()[0].CpuData(), bias, dst);
+                        Epilogue(NULL, add, 0, _trans ? _conv.dstH * _conv.dstW : _conv.dstC, _ldD, dst);
                     }
                     else
                     {
-                        for (size_t g = 0; g < _conv.group; ++g)
-                            CpuGemm(CblasNoTrans, CblasNoTrans, _siD, _siS, _siW, Type(1), weight + _grW * g, _ldW, tmp + _grS * g, _ldS, Type(0), dst + _grD * g, _ldD);
-                    }
-                    if (_biasTerm)
-                        CpuAddBias(this->Weight()[1].CpuData(), _conv.dstC, _conv.dstH*_conv.dstW, dst, _trans);
-                    switch (_conv.activation)
-                    {
-                    case ActivationFunctionTypeIdentity:
-                        break;
-                    case ActivationFunctionTypeRelu:
-                        CpuRelu(dst, _dstSize, 0.0f, dst);
-                        break;
-                    case ActivationFunctionTypeLeakyRelu:
-                        CpuRelu(dst, _dstSize, _params[0], dst);
-                        break;
-                    case ActivationFunctionTypeRestrictRange:
-                        CpuRestrictRange(dst, _dstSize, _params[0], _params[1], dst);
-                        break;
-                    case ActivationFunctionTypePrelu:
-                        Detail::PreluLayerForwardCpu(dst, this->Weight().back().CpuData(), _conv.dstC, _conv.dstH * _conv.dstW, dst, _trans);
-                        break;
-                    case ActivationFunctionTypeElu:
-                        CpuElu(dst, _dstSize, _params[0], dst);
-                        break;
-                    case ActivationFunctionTypeHswish:
-                        Detail::HswishLayerForwardCpu(dst, _dstSize, _params[0], _params[1], dst);
-                        break;
-                    default:
-                        assert(0);
+                        if (_winograd.Enable())
+                        {
+                            _winograd.Convolution(src, buf0, buf1, dst);
+                            Epilogue(bias, add, 0, _conv.dstC, _ldD, dst);
+                        }
+                        else
+                        {
+                            const Type * weight = _weightP.CpuData();
+                            size_t packed = _weightP.Size() / _conv.group;
+                            const Type * tmp = src;
+                            if (!_is1x1)
+                            {
+                                if (_trans)
+                                    Synet::ImgToRow(tmp, _conv.srcH, _conv.srcW, _conv.srcC, _conv.kernelY, _conv.kernelX,
+                                        _conv.padY, _conv.padX, _conv.padH, _conv.padW, _conv.strideY, _conv.strideX, _conv.dilationY, _conv.dilationX, _conv.group, _zero.CpuData(), buf0);
+                                else
+                                    Synet::ImgToCol(tmp, _conv.srcC, _conv.srcH, _conv.srcW, _conv.kernelY, _conv.kernelX,
+                                        _conv.padY, _conv.padX, _conv.padH, _conv.padW, _conv.strideY, _conv.strideX, _conv.dilationY, _conv.dilationX, _zero.CpuData(), buf0);
+                                tmp = buf0;
+                            }
+                            T * img = dst;
+                            auto post = [this, bias, add, img](size_t rows, size_t cols, T * ptr, size_t ld) { Epilogue(bias, add, ptr - img, rows, cols, img); };
+                            if (_trans)
+                            {
+                                assert(_conv.group == 1 || _conv.group == _conv.srcC);
+                                for (size_t g = 0; g < _conv.group; ++g)
+                                    CpuGemmPacked(CblasNoTrans, CblasNoTrans, _siS, _siD, _siW, Type(1), tmp + _grS * g, _ldS, (const Type*)NULL, (const Type*)NULL, _ldW, weight + packed * g, Type(0), dst + _grD * g, _ldD, post);
+                            }
+                            else
+                            {
+                                for (size_t g = 0; g < _conv.group; ++g)
+                                    CpuGemmPacked(CblasNoTrans, CblasNoTrans, _siD, _siS, _siW, Type(1), (const Type*)NULL, _ldW, weight + packed * g, tmp + _grS * g, _ldS, (const Type*)NULL, Type(0), dst + _grD * g, _ldD, post);
+                            }
+                        }
                     }
                     src += _srcSize;
                     dst += _dstSize;
+                    if (add)
+                        add += _dstSize;
                 }
             }
         }
 
+        void Epilogue(const T * bias, const T * add, size_t offset, size_t rows, size_t cols, T * dst)
+        {
+            for (size_t i = 0; i < rows; ++i, offset += _ldD)
+            {
+                T * pd = dst + offset;
+                const T * pa = add ? add + offset : NULL;
+                size_t channel = _trans ? offset % _ldD : offset / _ldD;
+                if (_trans && bias)
+                {
+                    const T * pb = bias + channel;
+                    if (pa)
+                        for (size_t j = 0; j < cols; ++j)
+                            pd[j] += pb[j] + pa[j];
+                    else
+                        for (size_t j = 0; j < cols; ++j)
+                            pd[j] += pb[j];
+                }
+                else if (bias)
+                {
+                    const T pb = bias[channel];
+                    if (pa)
+                        for (size_t j = 0; j < cols; ++j)
+                            pd[j] += pb + pa[j];
+                    else
+                        for (size_t j = 0; j < cols; ++j)
+                            pd[j] += pb;
+                }
+                else if (pa)
+                {
+                    for (size_t j = 0; j < cols; ++j)
+                        pd[j] += pa[j];
+                }
+                Activate(pd, cols, channel);
+            }
+        }
+
+        void Activate(T * dst, size_t size, size_t channel)
+        {
+            switch (_conv.activation)
+            {
+            case ActivationFunctionTypeIdentity:
+                break;
+            case ActivationFunctionTypeRelu:
+                CpuRelu(dst, size, 0.0f, dst);
+                break;
+            case ActivationFunctionTypeLeakyRelu:
+                CpuRelu(dst, size, _params[0], dst);
+                break;
+            case ActivationFunctionTypeRestrictRange:
+                CpuRestrictRange(dst, size, _params[0], _params[1], dst);
+                break;
+            case ActivationFunctionTypePrelu:
+                if (_trans)
+                    Detail::PreluLayerForwardCpu(dst, this->Weight().back().CpuData() + channel, size, 1, dst, 1);
+                else
+                    CpuRelu(dst, size, this->Weight().back().CpuData()[channel], dst);
+                break;
+            case ActivationFunctionTypeElu:
+                CpuElu(dst, size, _params[0], dst);
+                break;
+            case ActivationFunctionTypeHswish:
+                Detail::HswishLayerForwardCpu(dst, size, _params[0], _params[1], dst);
+                break;
+            default:
+                assert(0);
+            }
+        }
+
+        void InitWinograd(size_t block)
+        {
+            _winograd.Init(Shape({ _conv.srcC, _conv.srcH, _conv.srcW }), _conv.dstC, Shape({ _conv.kernelY, _conv.kernelX }), Shape({ _conv.strideY, _conv.strideX }),
+                Shape({ _conv.dilationY, _conv.dilationX }), Shape({ _conv.padY, _conv.padX, _conv.padH, _conv.padW }), _conv.group, block);
+        }
+
+        void PackWeight()
+        {
+            if (_weightP.Size())
+                return;
+            const Type * weight = this->Weight()[0].CpuData();
+            size_t packed = _trans ? CpuGemmPackedSizeB<Type>(_siD, _siW) : CpuGemmPackedSizeA<Type>(_siD, _siW);
+            _weightP.Clear();
+            _weightP.Reshape(Shape({ _conv.group, packed }));
+            for (size_t g = 0; g < _conv.group; ++g)
+            {
+                if (_trans)
+                    CpuGemmPackB(CblasNoTrans, _siD, _siW, weight + _grW * g, _ldW, _weightP.CpuData() + packed * g);
+                else
+                    CpuGemmPackA(CblasNoTrans, _siD, _siW, weight + _grW * g, _ldW, _weightP.CpuData() + packed * g);
+            }
+        }
+
         void Init8i()
         {
             Stat & statS = *this->Stats(0)[0];
@@ -299,9 +638,16 @@ namespace Synet
             statS.Init8u();
             statD.Init8u();
             _negSrc = statS.negative;
-            _weight8i.Reshape(this->Weight()[0].Shape(), _trans ? TensorFormatNhwc : TensorFormatNchw);
-            _norm32i.Reshape(Shape({ size_t(2), _conv.dstC }));
-            _norm32f.Reshape(Shape({ size_t(2), _conv.dstC }));
+            bool quantized = _weight8i.Size() != 0;
+            if (!quantized)
+            {
+                _weight8i.Clear();
+                _weight8i.Reshape(this->Weight()[0].Shape(), _trans ? TensorFormatNhwc : TensorFormatNchw);
+                _norm32i.Clear();
+                _norm32i.Reshape(Shape({ size_t(2), _conv.dstC }));
+                _norm32f.Clear();
+                _norm32f.Reshape(Shape({ size_t(2), _conv.dstC }));
+            }
             if (!_src8u)
             {
                 _srcCvt.batch = _num;
@@ -333,6 +679,8 @@ namespace Synet
             _dstCvt.format = (TensorFormat)_trans;
             _dstCvt.scale = pNormScale;
             _dstCvt.shift = pNormShift;
+            if (quantized)
+                return;
             for (size_t g = 0; g < G; ++g)
             {
                 for (size_t d = 0; d < D; ++d)
@@ -449,12 +797,37 @@ namespace Synet
             }
         }
 
-        void ForwardCpu8i(const uint8_t * src, uint8_t * buf, int32_t * dst)
+        bool Packed8i() const
+        {
+#ifdef SYNET_INT8_INT8_DISABLE
+            return true;
+#else
+            return !_negSrc;
+#endif
+        }
+
+        void PackWeight8i()
+        {
+            size_t Q4 = _order8i.size();
+            _weight8iP.Clear();
+            if (_trans)
+            {
+                _weight8iP.Reshape(Shape({ CpuGemm8iPackedSizeB(_conv.dstC, Q4 / 4) }));
+                CpuGemm8iPackB(_conv.dstC, _order8i, _weight8i.CpuData(), _ldW, _weight8iP.CpuData());
+            }
+            else
+            {
+                _weight8iP.Reshape(Shape({ _conv.dstC * Q4 }));
+                CpuGemm8iPackA(_conv.dstC, _order8i, _weight8i.CpuData(), _ldW, _weight8iP.CpuData());
+            }
+        }
+
+        template<class D> void ForwardCpu8i(const uint8_t * src, uint8_t * buf, int32_t * sum, D * dst)
         {
             const uint8_t * zero = this->Stats(0)[0]->zero8u.data();
             const int8_t * weight = _weight8i.CpuData();
-            const int32_t * scale = _norm32i.CpuData();
-            const int32_t * shift = scale + _conv.dstC;
+            const int8_t * packed = _weight8iP.Size() ? _weight8iP.CpuData() : NULL;
+            size_t Q4 = _order8i.size(), Q = Q4 / 4;
             for (size_t n = 0; n < _num; ++n)
             {
                 const uint8_t * tmp = src;
@@ -471,45 +844,109 @@ namespace Synet
                 if (_trans)
                 {
                     assert(_conv.group == 1 || _conv.group == _conv.srcC);
-                    if(_conv.group == 1)
-                        CpuGemmNN(_siS, _siD, _conv.kernelY*_conv.kernelX, _conv.srcC, tmp, _ldS, weight, _ldW, dst, _ldD);
+                    if (_conv.group == 1)
+                    {
+                        for (size_t i = 0; i < _siS; i += _tile8i)
+                        {
+                            size_t rows = std::min(_siS, i + _tile8i) - i;
+                            if (packed && _direct8i)
+                                CpuGemm8i(rows, _siD, Q, tmp + i * _ldS, _ldS, packed, sum, _ldD);
+                            else if (packed)
+                            {
+                                uint8_t * rowsP = (uint8_t*)(sum + _tile8i * _ldD);
+                                CpuGemm8iPackA(rows, _order8i, tmp + i * _ldS, _ldS, rowsP);
+                                CpuGemm8i(rows, _siD, Q, rowsP, Q4, packed, sum, _ldD);
+                            }
+                            else
+                                CpuGemmNN(rows, _siD, _conv.kernelY*_conv.kernelX, _conv.srcC, tmp + i * _ldS, _ldS, weight, _ldW, sum, _ldD);
+                            Requantize8i(sum, 0, rows, dst + i * _ldD);
+                        }
+                    }
                     else
+                    {
                         for (size_t g = 0; g < _conv.group; ++g)
-                            Synet::CpuGemmNN(_siS, _siD, _siW, tmp + _grS * g, _ldS, weight + _grW * g, _ldW, dst + _grD * g, _ldD);
+                            Synet::CpuGemmNN(_siS, _siD, _siW, tmp + _grS * g, _ldS, weight + _grW * g, _ldW, sum + _grD * g, _ldD);
+                        Requantize8i(sum, 0, _siS, dst);
+                    }
                 }
                 else
                 {
-                    if (_conv.group == 1)
-                        CpuGemmNN(_siD, _siS, _conv.srcC, _conv.kernelY*_conv.kernelX, weight, _ldW, tmp, _ldS, dst, _ldD);
+                    if (_conv.group == 1 && packed)
+                    {
+                        uint8_t * srcP = (uint8_t*)(sum + std::max(_tile8i * _ldD, _conv.dstC * _cols8i));
+                        for (size_t j = 0; j < _siS; j += _cols8i)
+                        {
+                            size_t cols = std::min(_siS, j + _cols8i) - j;
+                            CpuGemm8iPackB(cols, _order8i, tmp + j, _ldS, srcP);
+                            CpuGemm8i(_siD, cols, Q, packed, Q4, srcP, sum, cols);
+                            Requantize8iCols(sum, cols, dst + j);
+                        }
+                    }
+                    else if (_conv.group == 1)
+                    {
+                        for (size_t i = 0; i < _siD; i += _tile8i)
+                        {
+                            size_t rows = std::min(_siD, i + _tile8i) - i;
+                            CpuGemmNN(rows, _siS, _conv.srcC, _conv.kernelY*_conv.kernelX, weight + i * _ldW, _ldW, tmp, _ldS, sum, _ldD);
+                            Requantize8i(sum, i, rows, dst + i * _ldD);
+                        }
+                    }
                     else
+                    {
                         for (size_t g = 0; g < _conv.group; ++g)
-                            Synet::CpuGemmNN(_siD, _siS, _siW, weight + _grW * g, _ldW, tmp + _grS * g, _ldS, dst + _grD * g, _ldD);
+                            Synet::CpuGemmNN(_siD, _siS, _siW, weight + _grW * g, _ldW, tmp + _grS * g, _ldS, sum + _grD * g, _ldD);
+                        Requantize8i(sum, 0, _conv.dstC, dst);
+                    }
                 }
-                Detail::ScaleLayerForwardCpu(dst, scale, shift, _conv.dstC, _conv.dstH, _conv.dstW, dst, _trans, 1);
+                src += _srcSize;
+                dst += _dstSize;
+            }
+        }
 
-                switch (_conv.activation)
+        template<class D> void Requantize8i(const int32_t * sum, size_t first, size_t rows, D * dst)
+        {
+            const int32_t * scale = _norm32i.CpuData();
+            const int32_t * shift = scale + _conv.dstC;
+            assert(_conv.activation == ActivationFunctionTypeIdentity || _conv.activation == ActivationFunctionTypeRelu);
+            const int32_t lower = _conv.activation == ActivationFunctionTypeRelu ? 0 : INT_MIN;
+            if (_trans)
+            {
+                for (size_t i = 0; i < rows; ++i)
                 {
-                case ActivationFunctionTypeIdentity:
-                    break;
-                case ActivationFunctionTypeRelu:
-                    CpuRelu(dst, _dstSize, 0, dst);
-                    break;
-                //case ActivationFunctionTypeLeakyRelu:
-                //    CpuRelu(dst, _dstSize, _params[0], dst);
-                //    break;
-                //case ActivationFunctionTypeRestrictRange:
-                //    CpuRestrictRange(dst, _dstSize, _params[0], _params[1], dst);
-                //    break;
-                //case ActivationFunctionTypePrelu:
-                //    Detail::PreluLayerForwardCpu(dst, this->Weight().back().CpuData(), _conv.dstC, _conv.dstH * _conv.dstW, dst, _trans);
-                //    break;
-                default:
-                    assert(0);
+                    for (size_t c = 0; c < _conv.dstC; ++c)
+                        Detail::Convert32iTo(std::max(lower, sum[c] * scale[c] + shift[c]), _dstCvt.scale[c], _dstCvt.shift[c], dst[c]);
+                    sum += _ldD;
+                    dst += _ldD;
+                }
+            }
+            else
+            {
+                for (size_t i = 0, c = first; i < rows; ++i, ++c)
+                {
+                    const int32_t _scale = scale[c], _shift = shift[c];
+                    const float cvtScale = _dstCvt.scale[c], cvtShift = _dstCvt.shift[c];
+                    for (size_t s = 0; s < _siS; ++s)
+                        Detail::Convert32iTo(std::max(lower, sum[s] * _scale + _shift), cvtScale, cvtShift, dst[s]);
+                    sum += _ldD;
+                    dst += _ldD;
                 }
-                src += _srcSize;
-                dst += _dstSize;
             }
+        }
 
+        template<class D> void Requantize8iCols(const int32_t * sum, size_t cols, D * dst)
+        {
+            const int32_t * scale = _norm32i.CpuData();
+            const int32_t * shift = scale + _conv.dstC;
+            const int32_t lower = _conv.activation == ActivationFunctionTypeRelu ? 0 : INT_MIN;
+            for (size_t c = 0; c < _conv.dstC; ++c)
+            {
+                const int32_t _scale = scale[c], _shift = shift[c];
+                const float cvtScale = _dstCvt.scale[c], cvtShift = _dstCvt.shift[c];
+                for (size_t s = 0; s < cols; ++s)
+                    Detail::Convert32iTo(std::max(lower, sum[s] * _scale + _shift), cvtScale, cvtShift, dst[s]);
+                sum += cols;
+                dst += _ldD;
+            }
         }
 
         void CpuGemmNN(size_t S, size_t D, size_t K, size_t C, const uint8_t * src, size_t lda, const int8_t * weight, size_t ldb, int32_t * dst, size_t ldc)
@@ -630,16 +1067,22 @@ namespace Synet
         }
 
     private:
-        bool _is1x1, _biasTerm, _is8i, _src8u, _dst8u, _negSrc;
+        bool _is1x1, _biasTerm, _add, _is8i, _src8u, _dst8u, _negSrc, _sharedP, _sharedW, _direct8i;
         ConvertParam _srcCvt, _dstCvt;
         int _trans, _internal;
         ConvParam _conv;
-        size_t _axis, _num, _srcSize, _dstSize, _ldW, _ldS, _ldD, _grW, _grS, _grD, _siW, _siS, _siD;
+        size_t _axis, _num, _srcSize, _dstSize, _ldW, _ldS, _ldD, _grW, _grS, _grD, _siW, _siS, _siD, _tile8i, _cols8i;
         float _params[2];
 
         Convolution32f<Type> _convolution32f;
+        DepthwisePtr _depthwise;
+        Winograd<Type> _winograd;
+        Ints _algorithms;
+        int _algorithm;
 
-        Tensor8i _weight8i;
+        Tensor _weightP, _zero;
+        Tensor8i _weight8i, _weight8iP;
+        Ints _order8i;
         Tensor32i _norm32i;
         Tensor32f _norm32f;
     };
@@ -54,7 +54,7 @@ namespace Synet
             return Base::MemoryUsage() + (_deconvolution32f.InternalBufferSize() + _weightT.Size())*sizeof(Type);
         }
 
-        virtual void CompactWeight()
+        virtual void CompactWeight(bool keepSource)
         {
             if (_internal || _transW)
                 ((Tensor&)this->Weight()[0]).Clear();
@@ -149,6 +149,8 @@ namespace Synet
             else
             {
                 buf[TensorType32f*BUFFER_COUNT]->Extend(Shape({ _conv.dstC * _conv.kernelY * _conv.kernelX * _conv.srcH * _conv.srcW }));
+                if (!_is1x1)
+                    _zero.Reshape({ _conv.dstC }, Type(0));
                 if (_transW)
                 {
                     const Shape & shape = weight[0].Shape();
@@ -204,11 +206,11 @@ namespace Synet
                         if (_trans)
                         {
                             Synet::RowToImg(tmp, _conv.dstH, _conv.dstW, _conv.dstC, _conv.kernelY, _conv.kernelX,
-                                _conv.padY, _conv.padX, _conv.padH, _conv.padW, _conv.strideY, _conv.strideX, _conv.dilationY, _conv.dilationX, _conv.group, (const Type*)NULL, dst);
+                                _conv.padY, _conv.padX, _conv.padH, _conv.padW, _conv.strideY, _conv.strideX, _conv.dilationY, _conv.dilationX, _conv.group, _zero.CpuData(), dst);
                         }
                         else
                             Synet::ColToImg(tmp, _conv.dstC, _conv.dstH, _conv.dstW, _conv.kernelY, _conv.kernelX,
-                                _conv.padY, _conv.padX, _conv.padH, _conv.padW, _conv.strideY, _conv.strideX, _conv.dilationY, _conv.dilationX, (const Type*)NULL, dst);
+                                _conv.padY, _conv.padX, _conv.padH, _conv.padW, _conv.strideY, _conv.strideX, _conv.dilationY, _conv.dilationX, _zero.CpuData(), dst);
                     }
                     if (_biasTerm)
                         CpuAddBias(this->Weight()[1].CpuData(), _conv.dstC, _conv.dstH*_conv.dstW, dst, _trans);
@@ -252,6 +254,6 @@ namespace Synet
 
         Deconvolution32f<Type> _deconvolution32f;
 
-        Tensor _weightT;
+        Tensor _weightT, _zero;
     };
 }
\ No newline at end of file
@@ -26,6 +26,7 @@
 
 #include "Synet/Common.h"
 #include "Synet/Layer.h"
+#include "Synet/Utils/Parallel.h"
 
 namespace Synet
 {
@@ -60,40 +61,27 @@ namespace Synet
             _topK = param.nms().topK();
             _eta = param.nms().eta();            
             
-            //assert(src[0]->Shape() == src[1]->Shape());
-            _bboxPreds.Reshape(src[0]->Shape());
-            if (_shareLocation)
-                _bboxPermute.Reshape(src[0]->Shape());
-            _confPermute.Reshape(src[1]->Shape());
+            _num = src[0]->Axis(0);
             _numPriors = src[2]->Axis(2) / 4;
             assert(_numPriors * _numLocClasses * 4 == src[0]->Axis(1));
             assert(_numPriors * _numClasses == src[1]->Axis(1));
-            Shape shape(2, 1);
-            shape.push_back(1);
-            shape.push_back(7);
-            dst[0]->Reshape(shape);
+            _capacity = _topK > -1 ? std::min<size_t>(_topK, _numPriors) : _numPriors;
+            _candidates.resize(_num * _numClasses * _numPriors);
+            _boxes.resize(_num * _numClasses * _capacity * 4);
+            _kept.resize(_num * _numClasses * _capacity);
+            _keptCount.resize(_num * _numClasses);
+            _maxClass.resize(_keepMaxClassScoresOnly ? _num * _numPriors : 0);
+            _detections.resize(_numClasses * _capacity);
+            size_t maxKept = _numClasses * _capacity;
+            if (_keepTopK > -1)
+                maxKept = std::min<size_t>(maxKept, _keepTopK);
+            _output.Reshape(Shape({ 1, 1, std::max<size_t>(_num * maxKept, _num), 7 }));
+            _dstShape = Shape({ 1, 1, 1, 7 });
+            dst[0]->ShareAs(_output.CpuData(), _dstShape[2] * 7, _dstShape);
             this->UsePerfStat();
         }
 
-        struct NormalizedBBox
-        {
-            float xmin;
-            float ymin;
-            float xmax;
-            float ymax;
-            int32_t label;
-            bool difficult;
-            float score;
-            float size;
-
-            NormalizedBBox()
-                : xmin(0), ymin(0), xmax(0), ymax(0)
-                , label(0), difficult(false), score(0), size(0)
-            {
-            }
-        };
-
-        void GetRegions(const TensorPtrs & src, Type threshold, Regions & dst)
+        void GetRegions(const TensorPtrs & src, Type threshold, Regions & dst, ptrdiff_t image = -1)
         {
             SYNET_PERF_FUNC();
             dst.clear();
@@ -101,7 +89,7 @@ namespace Synet
             size_t count = src[0]->Axis(2);
             for (size_t i = 0; i < count; ++i)
             {
-                if (pSrc[2] > threshold)
+                if (pSrc[2] > threshold && (image < 0 || (ptrdiff_t)pSrc[0] == image))
                 {
                     Region r;
                     r.id = (size_t)pSrc[1];
@@ -119,471 +107,274 @@ namespace Synet
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
-            const Type * pLoc = src[0]->CpuData();
-            const Type * pConf = src[1]->CpuData();
-            const Type * pPrior = src[2]->CpuData();
-            size_t num = src[0]->Axis(0);
-
-            LabelBBoxes allLocPreds;
-            GetLocPredictions(pLoc, num, _numPriors, _numLocClasses, _shareLocation, allLocPreds);
-
-            LabelPreds allConfScores;
-            GetConfidenceScores(pConf, num, _numPriors, _numClasses, allConfScores, false);
+            const Type * loc = src[0]->CpuData();
+            const Type * conf = src[1]->CpuData();
+            const Type * prior = src[2]->CpuData();
 
             if (_keepMaxClassScoresOnly)
             {
-                for (size_t i = 0; i < num; ++i) 
+                ParallelFor(0, _num * _numPriors, [&](size_t begin, size_t end)
                 {
-                    LabelPred & labelScores = allConfScores[i];
-                    for (size_t p = 0; p < _numPriors; ++p)
-                    {
-                        float maxScore = 0.0f;
-                        int maxScoreIdx = -1;
-                        for (size_t c = 0; c < _numClasses; ++c)
-                        {
-                            if (labelScores[(int)c][p] >= maxScore && c != _backgroundLabelId)
-                            {
-                                maxScoreIdx = (int)c;
-                                maxScore = labelScores[(int)c][p];
-                            }
-                        }
-                        for (size_t c = 0; c < _numClasses; ++c)
-                            if (c != maxScoreIdx && c != _backgroundLabelId)
-                                labelScores[(int)c][p] = 0.0f;
-                    }
-                }
+                    for (size_t i = begin; i < end; ++i)
+                        _maxClass[i] = MaxClass(conf + i * _numClasses);
+                }, ParallelGrain(_numClasses));
             }
 
-            NormalizedBBoxes priorBboxes;
-            Variances priorVariances;
-            GetPriorBBoxes(pPrior, _numPriors, priorBboxes, priorVariances);
-
-            LabelBBoxes allDecodeBboxes;
-            DecodeBBoxesAll(allLocPreds, priorBboxes, priorVariances, num, _shareLocation, _numLocClasses, 
-                _backgroundLabelId, _codeType, _varianceEncodedInTarget, _clip, allDecodeBboxes);
+            ParallelFor(0, _num * _numClasses, [&](size_t begin, size_t end)
+            {
+                for (size_t t = begin; t < end; ++t)
+                    DetectClass(loc, conf, prior, t / _numClasses, t % _numClasses);
+            }, ParallelGrain(_numPriors));
 
             size_t numKept = 0;
-            IndexMaps allIndices;
-            for (size_t i = 0; i < num; ++i) 
+            for (size_t i = 0; i < _num; ++i)
             {
-                const LabelBBox & decodeBboxes = allDecodeBboxes[i];
-                const LabelPred & confScores = allConfScores[i];
-                IndexMap indices;
                 size_t numDet = 0;
                 for (size_t c = 0; c < _numClasses; ++c)
-                {
-                    if (c == _backgroundLabelId)
-                        continue;
-                    assert(confScores.find((int)c) != confScores.end());
-                    const Floats & scores = confScores.find((int)c)->second;
-                    int label = _shareLocation ? -1 : (int)c;
-                    assert(decodeBboxes.find(label) != decodeBboxes.end());
-                    const NormalizedBBoxes & bboxes = decodeBboxes.find(label)->second;
-                    ApplyNMSFast(bboxes, scores, _confidenceThreshold, _nmsThreshold, _eta, _topK, indices[(int)c]);
-                    numDet += indices[(int)c].size();
-                }
-                if (_keepTopK > -1 && numDet > (size_t)_keepTopK)
-                {
-                    ScoreIndexPairs scoreIndexPairs;
-                    for (IndexMap::iterator it = indices.begin(); it != indices.end(); ++it) 
-                    {
-                        int label = it->first;
-                        const Index & labelIndices = it->second;
-                        assert(confScores.find(label) != confScores.end());
-                        const Floats & scores = confScores.find(label)->second;
-                        for (size_t j = 0; j < labelIndices.size(); ++j) 
-                        {
-                            size_t idx = labelIndices[j];
-                            scoreIndexPairs.push_back(ScoreIndexPair(scores[idx], IndexPair(label, idx)));
-                        }
-                    }
-                    std::sort(scoreIndexPairs.begin(), scoreIndexPairs.end(), [](const ScoreIndexPair & a, const ScoreIndexPair & b) { return a.first > b.first; });
-                    scoreIndexPairs.resize(_keepTopK);
-                    IndexMap newIndices;
-                    for (size_t j = 0; j < scoreIndexPairs.size(); ++j)
-                    {
-                        size_t label = scoreIndexPairs[j].second.first;
-                        size_t idx = scoreIndexPairs[j].second.second;
-                        newIndices[(int)label].push_back(idx);
-                    }
-                    allIndices.push_back(newIndices);
-                    numKept += _keepTopK;
-                }
-                else 
-                {
-                    allIndices.push_back(indices);
-                    numKept += numDet;
-                }
+                    numDet += _keptCount[i * _numClasses + c];
+                numKept += _keepTopK > -1 ? std::min<size_t>(numDet, _keepTopK) : numDet;
             }
 
-            Shape shape(2, 1);
-            shape.push_back(numKept);
-            shape.push_back(7);
-            Type * pDst;
-            if (numKept == 0) 
+            _dstShape[2] = numKept ? numKept : _num;
+            dst[0]->ShareAs(_output.CpuData(), _dstShape[2] * 7, _dstShape);
+            Type * pDst = dst[0]->CpuData();
+            if (numKept == 0)
             {
-                shape[2] = num;
-                dst[0]->Reshape(shape);
-                pDst = dst[0]->CpuData();
                 CpuSet(dst[0]->Size(), Type(-1), pDst);
-                for (size_t i = 0; i < num; ++i) 
+                for (size_t i = 0; i < _num; ++i)
                 {
                     pDst[0] = Type(i);
                     pDst += 7;
                 }
-            }
-            else 
-            {
-                dst[0]->Reshape(shape);
-                pDst = dst[0]->CpuData();
+                return;
             }
 
-            size_t count = 0;
-            for (size_t i = 0; i < num; ++i) 
+            for (size_t i = 0; i < _num; ++i)
             {
-                const LabelPred & confScores = allConfScores[i];
-                const LabelBBox & decodeBboxes = allDecodeBboxes[i];
-                for (IndexMap::iterator it = allIndices[i].begin(); it != allIndices[i].end(); ++it) 
+                size_t numDet = 0;
+                for (size_t c = 0; c < _numClasses; ++c)
                 {
-                    int label = it->first;
-                    assert(confScores.find(label) != confScores.end());
-                    const Floats & scores = confScores.find(label)->second;
-                    int locLabel = _shareLocation ? -1 : label;
-                    assert(decodeBboxes.find(locLabel) != decodeBboxes.end());
-                    const NormalizedBBoxes & bboxes = decodeBboxes.find(locLabel)->second;
-                    Index & indices = it->second;
-                    for (size_t j = 0; j < indices.size(); ++j) 
+                    size_t t = i * _numClasses + c;
+                    const int * kept = _kept.data() + t * _capacity;
+                    for (size_t k = 0; k < _keptCount[t]; ++k, ++numDet)
                     {
-                        size_t idx = indices[j];
-                        pDst[count * 7 + 0] = Type(i);
-                        pDst[count * 7 + 1] = Type(label);
-                        pDst[count * 7 + 2] = scores[idx];
-                        const NormalizedBBox & bbox = bboxes[idx];
-                        pDst[count * 7 + 3] = bbox.xmin;
-                        pDst[count * 7 + 4] = bbox.ymin;
-                        pDst[count * 7 + 5] = bbox.xmax;
-                        pDst[count * 7 + 6] = bbox.ymax;
-                        ++count;
+                        Detection & d = _detections[numDet];
+                        d.score = Score(conf, i, c, kept[k]);
+                        d.label = (int)c;
+                        d.index = (int)k;
                     }
                 }
+                if (_keepTopK > -1 && numDet > (size_t)_keepTopK)
+                {
+                    std::nth_element(_detections.begin(), _detections.begin() + _keepTopK, _detections.begin() + numDet, [](const Detection & a, const Detection & b)
+                    { 
+                        return a.score > b.score || (a.score == b.score && (a.label < b.label || (a.label == b.label && a.index < b.index)));
+                    });
+                    numDet = _keepTopK;
+                    std::sort(_detections.begin(), _detections.begin() + numDet, [](const Detection & a, const Detection & b)
+                    {
+                        return a.label < b.label || (a.label == b.label && a.index < b.index);
+                    });
+                }
+                for (size_t j = 0; j < numDet; ++j)
+                {
+                    const Detection & d = _detections[j];
+                    const Type * box = _boxes.data() + ((i * _numClasses + d.label) * _capacity + d.index) * 4;
+                    pDst[0] = Type(i);
+                    pDst[1] = Type(d.label);
+                    pDst[2] = d.score;
+                    pDst[3] = box[0];
+                    pDst[4] = box[1];
+                    pDst[5] = box[2];
+                    pDst[6] = box[3];
+                    pDst += 7;
+                }
             }
         }
+
     private:
+        struct Detection
+        {
+            Type score;
+            int label, index;
+        };
+        typedef std::vector<Detection> Detections;
+        typedef std::vector<Type> Vector;
         typedef typename Base::Tensor Tensor;
-        typedef std::map<int, std::vector<NormalizedBBox>> LabelBBox;
-        typedef std::vector<LabelBBox> LabelBBoxes;
-        typedef std::map<int, Floats> LabelPred;
-        typedef std::vector<LabelPred> LabelPreds;
-        typedef std::vector<NormalizedBBox> NormalizedBBoxes;
-        typedef std::vector<Type*> Variances;
-        typedef std::map<int, Index> IndexMap;
-        typedef std::vector<IndexMap> IndexMaps;
-        typedef std::pair<float, size_t> ScoreIndex;
-        typedef std::vector<ScoreIndex> ScoreIndeces;
-        typedef std::pair<size_t, size_t> IndexPair;
-        typedef std::pair<float, IndexPair> ScoreIndexPair;
-        typedef std::vector<ScoreIndexPair> ScoreIndexPairs;
 
         bool _shareLocation, _varianceEncodedInTarget, _keepMaxClassScoresOnly, _clip;
-        size_t _numClasses, _numLocClasses, _numPriors;
+        size_t _numClasses, _numLocClasses, _numPriors, _num, _capacity;
         ptrdiff_t _backgroundLabelId, _keepTopK, _topK;
         PriorBoxCodeType _codeType;
         float _confidenceThreshold, _nmsThreshold, _eta;
-        Tensor _bboxPreds, _bboxPermute, _confPermute;
+        Ints _candidates, _kept, _maxClass;
+        Vector _boxes;
+        Shape _keptCount, _dstShape;
+        Detections _detections;
+        Tensor _output;
 
-        void GetLocPredictions(const Type * pLoc, size_t num, size_t numPredsPerClass, size_t numLocClasses, bool shareLocation, LabelBBoxes & locPreds)
+        int MaxClass(const Type * scores) const
         {
-            locPreds.clear();
-            locPreds.resize(num);
-            for (size_t i = 0; i < num; ++i) 
+            int maxClass = -1;
+            Type maxScore = 0;
+            for (size_t c = 0; c < _numClasses; ++c)
             {
-                LabelBBox & labelBbox = locPreds[i];
-                for (size_t p = 0; p < numPredsPerClass; ++p)
+                if (scores[c] >= maxScore && (ptrdiff_t)c != _backgroundLabelId)
                 {
-                    size_t startIdx = p * numLocClasses * 4;
-                    for (size_t c = 0; c < numLocClasses; ++c)
-                    {
-                        int label = shareLocation ? -1 : (int)c;
-                        if (labelBbox.find(label) == labelBbox.end())
-                            labelBbox[label].resize(numPredsPerClass);
-                        labelBbox[label][p].xmin = pLoc[startIdx + c * 4 + 0];
-                        labelBbox[label][p].ymin = pLoc[startIdx + c * 4 + 1];
-                        labelBbox[label][p].xmax = pLoc[startIdx + c * 4 + 2];
-                        labelBbox[label][p].ymax = pLoc[startIdx + c * 4 + 3];
-                    }
+                    maxClass = (int)c;
+                    maxScore = scores[c];
                 }
-                pLoc += numPredsPerClass * numLocClasses * 4;
             }
+            return maxClass;
         }
 
-        void GetConfidenceScores(const Type * pConf, size_t num, size_t numPredsPerClass, size_t numClasses, LabelPreds & confPreds, bool keepMaxScoreOnly)
+        SYNET_INLINE Type Score(const Type * conf, size_t i, size_t c, size_t p) const
         {
-            confPreds.clear();
-            confPreds.resize(num);
-            for (size_t i = 0; i < num; ++i) 
-            {
-                LabelPred & labelScores = confPreds[i];
-                for (size_t p = 0; p < numPredsPerClass; ++p)
-                {
-                    size_t startIdx = p * numClasses;
-                    size_t maxClassScoreIdx = 0;
-                    float maxClassScore = 0;
-                    for (size_t c = 0; c < numClasses; ++c)
-                    {
-                        labelScores[(int)c].push_back(pConf[startIdx + c]);
-                        if (pConf[startIdx + c] >= maxClassScore)
-                        {
-                            maxClassScoreIdx = c;
-                            maxClassScore = pConf[startIdx + c];
-                        }
-                    }
-                    if (keepMaxScoreOnly)
-                    {
-                        for (size_t c = 0; c < numClasses; ++c)
-                            if (c != maxClassScoreIdx)
-                                labelScores[(int)c].back() = 0.0;
-                    }
-                }
-                pConf += numPredsPerClass * numClasses;
-            }
+            size_t offset = i * _numPriors + p;
+            if (_keepMaxClassScoresOnly && _maxClass[offset] != (int)c)
+                return Type(0);
+            return conf[offset * _numClasses + c];
         }
 
-        void GetPriorBBoxes(const Type * pPrior, size_t numPriors, NormalizedBBoxes & priorBboxes, Variances & priorVariances)
+        void DetectClass(const Type * loc, const Type * conf, const Type * prior, size_t i, size_t c)
         {
-            priorBboxes.clear();
-            priorVariances.clear();
-            priorBboxes.reserve(numPriors);
-            priorVariances.reserve(numPriors);
-            for (size_t i = 0; i < numPriors; ++i)
+            size_t t = i * _numClasses + c;
+            _keptCount[t] = 0;
+            if ((ptrdiff_t)c == _backgroundLabelId)
+                return;
+
+            int * candidates = _candidates.data() + t * _numPriors;
+            size_t count = 0;
+            for (size_t p = 0; p < _numPriors; ++p)
+                if (Score(conf, i, c, p) > _confidenceThreshold)
+                    candidates[count++] = (int)p;
+            auto greater = [&](int a, int b) 
             {
-                size_t startIdx = i * 4;
-                NormalizedBBox bbox;
-                bbox.xmin = pPrior[startIdx + 0];
-                bbox.ymin = pPrior[startIdx + 1];
-                bbox.xmax = pPrior[startIdx + 2];
-                bbox.ymax = pPrior[startIdx + 3];
-                float bboxSize = BBoxSize(bbox, true);
-                bbox.size = bboxSize;
-                priorBboxes.push_back(bbox);
-                priorVariances.push_back((Type*)(pPrior + (numPriors + i) * 4));
-            }
-        }
+                Type sa = Score(conf, i, c, a), sb = Score(conf, i, c, b);
+                return sa > sb || (sa == sb && a < b);
+            };
+            size_t top = std::min(count, _capacity);
+            if (top < count)
+                std::nth_element(candidates, candidates + top, candidates + count, greater);
+            std::sort(candidates, candidates + top, greater);
 
-        float BBoxSize(const NormalizedBBox & bbox, bool normalized) 
-        {
-            if (bbox.xmax < bbox.xmin || bbox.ymax < bbox.ymin) 
-                return 0;
-            else 
+            loc += (i * _numPriors * _numLocClasses + (_shareLocation ? 0 : c)) * 4;
+            Type * boxes = _boxes.data() + t * _capacity * 4;
+            int * kept = _kept.data() + t * _capacity;
+            float threshold = _nmsThreshold;
+            size_t keptCount = 0;
+            for (size_t j = 0; j < top; ++j)
             {
-                float w = bbox.xmax - bbox.xmin;
-                float h = bbox.ymax - bbox.ymin;
-                if (normalized)
-                    return w * h;
-                else 
-                    return (w + 1) * (h + 1);
+                size_t p = candidates[j];
+                Type * box = boxes + keptCount * 4;
+                DecodeBBox(prior + p * 4, prior + (_numPriors + p) * 4, loc + p * _numLocClasses * 4, box);
+                bool keep = true;
+                for (size_t k = 0; k < keptCount && keep; ++k)
+                    keep = JaccardOverlap(box, boxes + k * 4) <= threshold;
+                if (keep)
+                {
+                    kept[keptCount++] = (int)p;
+                    if (_eta < 1 && threshold > 0.5)
+                        threshold *= _eta;
+                }
             }
+            _keptCount[t] = keptCount;
         }
 
-        void ClipBBox(const NormalizedBBox & src, NormalizedBBox & dst) 
+        static SYNET_INLINE float BBoxSize(const Type * bbox)
         {
-            dst.xmin = std::max(std::min(src.xmin, 1.f), 0.f);
-            dst.ymin = std::max(std::min(src.ymin, 1.f), 0.f);
-            dst.xmax = std::max(std::min(src.xmax, 1.f), 0.f);
-            dst.ymax = std::max(std::min(src.ymax, 1.f), 0.f);
-            dst.size = BBoxSize(src, true);
-            dst.difficult = src.difficult;
+            if (bbox[2] < bbox[0] || bbox[3] < bbox[1])
+                return 0;
+            else
+                return (bbox[2] - bbox[0]) * (bbox[3] - bbox[1]);
         }
 
-        void DecodeBBox(const NormalizedBBox & priorBbox, const T * priorVariance, PriorBoxCodeType codeType, bool varianceEncodedInTarget,
-            bool clipBbox, const NormalizedBBox & bbox, NormalizedBBox & decodeBbox) 
+        void DecodeBBox(const Type * priorBbox, const Type * priorVariance, const Type * bbox, Type * decodeBbox) const
         {
-            if (codeType == PriorBoxCodeTypeCorner)
+            if (_codeType == PriorBoxCodeTypeCorner)
             {
-                if (varianceEncodedInTarget)
+                if (_varianceEncodedInTarget)
                 {
-                    decodeBbox.xmin = priorBbox.xmin + bbox.xmin;
-                    decodeBbox.ymin = priorBbox.ymin + bbox.ymin;
-                    decodeBbox.xmax = priorBbox.xmax + bbox.xmax;
-                    decodeBbox.ymax = priorBbox.ymax + bbox.ymax;
+                    decodeBbox[0] = priorBbox[0] + bbox[0];
+                    decodeBbox[1] = priorBbox[1] + bbox[1];
+                    decodeBbox[2] = priorBbox[2] + bbox[2];
+                    decodeBbox[3] = priorBbox[3] + bbox[3];
                 }
                 else
                 {
-
-                    decodeBbox.xmin = priorBbox.xmin + priorVariance[0] * bbox.xmin;
-                    decodeBbox.ymin = priorBbox.ymin + priorVariance[1] * bbox.ymin;
-                    decodeBbox.xmax = priorBbox.xmax + priorVariance[2] * bbox.xmax;
-                    decodeBbox.ymax = priorBbox.ymax + priorVariance[3] * bbox.ymax;
+                    decodeBbox[0] = priorBbox[0] + priorVariance[0] * bbox[0];
+                    decodeBbox[1] = priorBbox[1] + priorVariance[1] * bbox[1];
+                    decodeBbox[2] = priorBbox[2] + priorVariance[2] * bbox[2];
+                    decodeBbox[3] = priorBbox[3] + priorVariance[3] * bbox[3];
                 }
             }
-            else if (codeType == PriorBoxCodeTypeCenterSize)
+            else if (_codeType == PriorBoxCodeTypeCenterSize)
             {
-                float priorW = priorBbox.xmax - priorBbox.xmin;
-                float priorH = priorBbox.ymax - priorBbox.ymin;
-                float priorX = (priorBbox.xmin + priorBbox.xmax) / 2.0f;
-                float priorY = (priorBbox.ymin + priorBbox.ymax) / 2.0f;
+                float priorW = priorBbox[2] - priorBbox[0];
+                float priorH = priorBbox[3] - priorBbox[1];
+                float priorX = (priorBbox[0] + priorBbox[2]) / 2.0f;
+                float priorY = (priorBbox[1] + priorBbox[3]) / 2.0f;
                 float bboxX, bboxY, bboxW, bboxH;
-                if (varianceEncodedInTarget)
+                if (_varianceEncodedInTarget)
                 {
-                    bboxX = bbox.xmin * priorW + priorX;
-                    bboxY = bbox.ymin * priorH + priorY;
-                    bboxW = ::exp(bbox.xmax) * priorW;
-                    bboxH = ::exp(bbox.ymax) * priorH;
+                    bboxX = bbox[0] * priorW + priorX;
+                    bboxY = bbox[1] * priorH + priorY;
+                    bboxW = ::exp(bbox[2]) * priorW;
+                    bboxH = ::exp(bbox[3]) * priorH;
                 }
                 else
                 {
-                    bboxX = priorVariance[0] * bbox.xmin * priorW + priorX;
-                    bboxY = priorVariance[1] * bbox.ymin * priorH + priorY;
-                    bboxW = ::exp(priorVariance[2] * bbox.xmax) * priorW;
-                    bboxH = ::exp(priorVariance[3] * bbox.ymax) * priorH;
+                    bboxX = priorVariance[0] * bbox[0] * priorW + priorX;
+                    bboxY = priorVariance[1] * bbox[1] * priorH + priorY;
+                    bboxW = ::exp(priorVariance[2] * bbox[2]) * priorW;
+                    bboxH = ::exp(priorVariance[3] * bbox[3]) * priorH;
                 }
-                decodeBbox.xmin = bboxX - bboxW / 2.0f;
-                decodeBbox.ymin = bboxY - bboxH / 2.0f;
-                decodeBbox.xmax = bboxX + bboxW / 2.0f;
-                decodeBbox.ymax = bboxY + bboxH / 2.0f;
+                decodeBbox[0] = bboxX - bboxW / 2.0f;
+                decodeBbox[1] = bboxY - bboxH / 2.0f;
+                decodeBbox[2] = bboxX + bboxW / 2.0f;
+                decodeBbox[3] = bboxY + bboxH / 2.0f;
             }
-            else if (codeType == PriorBoxCodeTypeCornerSize)
+            else if (_codeType == PriorBoxCodeTypeCornerSize)
             {
-                float priorW = priorBbox.xmax - priorBbox.xmin;
-                float priorH = priorBbox.ymax - priorBbox.ymin;
-                if (varianceEncodedInTarget)
+                float priorW = priorBbox[2] - priorBbox[0];
+                float priorH = priorBbox[3] - priorBbox[1];
+                if (_varianceEncodedInTarget)
                 {
-                    decodeBbox.xmin = priorBbox.xmin + bbox.xmin * priorW;
-                    decodeBbox.ymin = priorBbox.ymin + bbox.ymin * priorH;
-                    decodeBbox.xmax = priorBbox.xmax + bbox.xmax * priorW;
-                    decodeBbox.ymax = priorBbox.ymax + bbox.ymax * priorH;
+                    decodeBbox[0] = priorBbox[0] + bbox[0] * priorW;
+                    decodeBbox[1] = priorBbox[1] + bbox[1] * priorH;
+                    decodeBbox[2] = priorBbox[2] + bbox[2] * priorW;
+                    decodeBbox[3] = priorBbox[3] + bbox[3] * priorH;
                 }
                 else
                 {
-                    decodeBbox.xmin = priorBbox.xmin + priorVariance[0] * bbox.xmin * priorW;
-                    decodeBbox.ymin = priorBbox.ymin + priorVariance[1] * bbox.ymin * priorH;
-                    decodeBbox.xmax = priorBbox.xmax + priorVariance[2] * bbox.xmax * priorW;
-                    decodeBbox.ymax = priorBbox.ymax + priorVariance[3] * bbox.ymax * priorH;
+                    decodeBbox[0] = priorBbox[0] + priorVariance[0] * bbox[0] * priorW;
+                    decodeBbox[1] = priorBbox[1] + priorVariance[1] * bbox[1] * priorH;
+                    decodeBbox[2] = priorBbox[2] + priorVariance[2] * bbox[2] * priorW;
+                    decodeBbox[3] = priorBbox[3] + priorVariance[3] * bbox[3] * priorH;
                 }
             }
             else
                 assert(0);
-            decodeBbox.size = BBoxSize(decodeBbox, true);
-            if (clipBbox)
-                ClipBBox(decodeBbox, decodeBbox);
-        }
-
-        void DecodeBBoxes(const NormalizedBBoxes & priorBboxes, const Variances & priorVariances, PriorBoxCodeType codeType, bool varianceEncodedInTarget,
-            bool clipBbox, const NormalizedBBoxes & bboxes, NormalizedBBoxes & decodeBboxes) 
-        {
-            size_t numBboxes = priorBboxes.size();
-            decodeBboxes.clear();
-            for (size_t i = 0; i < numBboxes; ++i) 
-            {
-                NormalizedBBox decodeBbox;
-                DecodeBBox(priorBboxes[i], priorVariances[i], codeType, varianceEncodedInTarget, clipBbox, bboxes[i], decodeBbox);
-                decodeBboxes.push_back(decodeBbox);
-            }
-        }
-
-        void DecodeBBoxesAll(const LabelBBoxes & allLocPreds, const NormalizedBBoxes & priorBboxes, const Variances & priorVariances, size_t num, 
-            bool shareLocation, size_t numLocClasses, size_t backgroundLabelId, PriorBoxCodeType codeType, bool varianceEncodedInTarget, bool clip, LabelBBoxes & allDecodeBboxes)
-        {
-            allDecodeBboxes.clear();
-            allDecodeBboxes.resize(num);
-            for (size_t i = 0; i < num; ++i) 
-            {
-                LabelBBox & decodeBboxes = allDecodeBboxes[i];
-                for (size_t c = 0; c < numLocClasses; ++c) 
-                {
-                    int label = shareLocation ? -1 : (int)c;
-                    if (label == backgroundLabelId)
-                        continue;
-                    assert(allLocPreds[i].find(label) != allLocPreds[i].end());
-                    const NormalizedBBoxes & labelLocPreds = allLocPreds[i].find(label)->second;
-                    DecodeBBoxes(priorBboxes, priorVariances, codeType, varianceEncodedInTarget, clip, labelLocPreds, decodeBboxes[label]);
-                }
-            }
-        }
-
-        void GetMaxScoreIndex(const Floats & scores, float threshold, ptrdiff_t topK, ScoreIndeces & scoreIndeces)
-        {
-            scoreIndeces.clear();
-            for (size_t i = 0; i < scores.size(); ++i) 
+            if (_clip)
             {
-                if (scores[i] > threshold)
-                    scoreIndeces.push_back(ScoreIndex(scores[i], i));
+                for (size_t j = 0; j < 4; ++j)
+                    decodeBbox[j] = std::max(std::min(decodeBbox[j], 1.f), 0.f);
             }
-            std::stable_sort(scoreIndeces.begin(), scoreIndeces.end(), [](const ScoreIndex & a, const ScoreIndex & b) { return a.first > b.first; });
-            if (topK > -1 && (size_t)topK < scoreIndeces.size())
-                scoreIndeces.resize(topK);
         }
 
-        void IntersectBBox(const NormalizedBBox & bbox1, const NormalizedBBox & bbox2, NormalizedBBox & intersect) 
+        static float JaccardOverlap(const Type * bbox1, const Type * bbox2)
         {
-            if (bbox2.xmin > bbox1.xmax || bbox2.xmax < bbox1.xmin || bbox2.ymin > bbox1.ymax || bbox2.ymax < bbox1.ymin)
-            {
-                intersect.xmin = 0;
-                intersect.ymin = 0;
-                intersect.xmax = 0;
-                intersect.ymax = 0;
-            }
-            else 
-            {
-                intersect.xmin = std::max(bbox1.xmin, bbox2.xmin);
-                intersect.ymin = std::max(bbox1.ymin, bbox2.ymin);
-                intersect.xmax = std::min(bbox1.xmax, bbox2.xmax);
-                intersect.ymax = std::min(bbox1.ymax, bbox2.ymax);
-            }
-        }
-
-        float JaccardOverlap(const NormalizedBBox & bbox1, const NormalizedBBox & bbox2, bool normalized) 
-        {
-            NormalizedBBox intersect;
-            IntersectBBox(bbox1, bbox2, intersect);
-            float intersectW, intersectH;
-            if (normalized) 
-            {
-                intersectW = intersect.xmax - intersect.xmin;
-                intersectH = intersect.ymax - intersect.ymin;
-            }
-            else 
-            {
-                intersectW = intersect.xmax - intersect.xmin + 1;
-                intersectH = intersect.ymax - intersect.ymin + 1;
-            }
-            if (intersectW > 0 && intersectH > 0) 
+            if (bbox2[0] > bbox1[2] || bbox2[2] < bbox1[0] || bbox2[1] > bbox1[3] || bbox2[3] < bbox1[1])
+                return 0;
+            float intersectW = std::min(bbox1[2], bbox2[2]) - std::max(bbox1[0], bbox2[0]);
+            float intersectH = std::min(bbox1[3], bbox2[3]) - std::max(bbox1[1], bbox2[1]);
+            if (intersectW > 0 && intersectH > 0)
             {
                 float intersectS = intersectW * intersectH;
-                float bbox1Size = BBoxSize(bbox1, true);
-                float bbox2Size = BBoxSize(bbox2, true);
-                return intersectS / (bbox1Size + bbox2Size - intersectS);
+                return intersectS / (BBoxSize(bbox1) + BBoxSize(bbox2) - intersectS);
             }
             else
                 return 0;
         }
-
-        void ApplyNMSFast(const NormalizedBBoxes & bboxes, const Floats & scores, float scoreThreshold, float nmsThreshold, float eta, ptrdiff_t topK, Index & indices)
-        {
-            ScoreIndeces scoreIndeces;
-            GetMaxScoreIndex(scores, scoreThreshold, topK, scoreIndeces);
-            float adaptiveThreshold = nmsThreshold;
-            indices.clear();
-            while (scoreIndeces.size() != 0)
-            {
-                size_t idx = scoreIndeces.front().second;
-                bool keep = true;
-                for (int k = 0; k < indices.size(); ++k) 
-                {
-                    if (keep)
-                    {
-                        size_t keptIdx = indices[k];
-                        float overlap = JaccardOverlap(bboxes[idx], bboxes[keptIdx], true);
-                        keep = overlap <= adaptiveThreshold;
-                    }
-                    else
-                        break;
-                }
-                if (keep)
-                    indices.push_back(idx);
-                scoreIndeces.erase(scoreIndeces.begin());
-                if (keep && eta < 1 && adaptiveThreshold > 0.5)
-                    adaptiveThreshold *= eta;
-            }
-        }
     };
 }
\ No newline at end of file
@@ -29,6 +29,7 @@
 #include "Synet/Layer.h"
 #include "Synet/Utils/Math.h"
 #include "Synet/Layers/ScaleLayer.h"
+#include "Synet/Utils/Parallel.h"
 
 namespace Synet
 {
@@ -37,31 +38,36 @@ namespace Synet
         template <class T> void EltwiseLayerForwardCpu(T const * const * src, const T * weight, size_t count, size_t size, EltwiseOperationType type, T * dst)
         {
             assert(count >= 2);
-            switch(type)
+            ParallelFor(0, size, [&](size_t begin, size_t end)
             {
-            case EltwiseOperationTypeProduct:
-                CpuMul(src[0], src[1], size, dst);
-                for (size_t i = 2; i < count; ++i)
-                    CpuMul(dst, src[i], size, dst);
-                break;
-            case EltwiseOperationTypeSum:
-                CpuScale(src[0], size, weight[0], dst);
-                for (size_t i = 1; i < count; ++i)
-                    CpuAxpy(src[i], size, weight[i], dst);
-                break;
-            case EltwiseOperationTypeMax:
-                CpuMax(src[0], src[1], size, dst);
-                for (size_t i = 2; i < count; ++i)
-                    CpuMax(dst, src[i], size, dst);
-                break;
-            case EltwiseOperationTypeMin:
-                CpuMin(src[0], src[1], size, dst);
-                for (size_t i = 2; i < count; ++i)
-                    CpuMin(dst, src[i], size, dst);
-                break;
-            default:
-                assert(0);
-            }
+                size_t part = end - begin;
+                T * pd = dst + begin;
+                switch (type)
+                {
+                case EltwiseOperationTypeProduct:
+                    CpuMul(src[0] + begin, src[1] + begin, part, pd);
+                    for (size_t i = 2; i < count; ++i)
+                        CpuMul(pd, src[i] + begin, part, pd);
+                    break;
+                case EltwiseOperationTypeSum:
+                    CpuScale(src[0] + begin, part, weight[0], pd);
+                    for (size_t i = 1; i < count; ++i)
+                        CpuAxpy(src[i] + begin, part, weight[i], pd);
+                    break;
+                case EltwiseOperationTypeMax:
+                    CpuMax(src[0] + begin, src[1] + begin, part, pd);
+                    for (size_t i = 2; i < count; ++i)
+                        CpuMax(pd, src[i] + begin, part, pd);
+                    break;
+                case EltwiseOperationTypeMin:
+                    CpuMin(src[0] + begin, src[1] + begin, part, pd);
+                    for (size_t i = 2; i < count; ++i)
+                        CpuMin(pd, src[i] + begin, part, pd);
+                    break;
+                default:
+                    assert(0);
+                }
+            }, ParallelGrain(count));
         }
 
 #ifdef SYNET_SIMD_LIBRARY_ENABLE
@@ -122,10 +128,7 @@ namespace Synet
                 _scale = 0;
                 _src.resize(src.size());
                 for (size_t i = 0; i < src.size(); ++i)
-                {
                     assert(src[i]->Shape() == src[0]->Shape());
-                    _src[i] = src[i]->CpuData();
-                }
             }
             dst[0]->Reshape(src[0]->Shape(), src[0]->Format());
             this->UsePerfStat();
@@ -153,6 +156,8 @@ namespace Synet
             }
             else
             {
+                for (size_t i = 0; i < src.size(); ++i)
+                    _src[i] = src[i]->CpuData();
                 Detail::EltwiseLayerForwardCpu(_src.data(), _coefficients.data(), _src.size(), dst[0]->Size(), _operation, dst[0]->CpuData());
             }
         }
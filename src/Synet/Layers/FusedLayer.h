@@ -27,6 +27,7 @@
 #include "Synet/Common.h"
 #include "Synet/Layer.h"
 #include "Synet/Layers/ScaleLayer.h"
+#include "Synet/Utils/Parallel.h"
 
 namespace Synet
 {
@@ -41,23 +42,29 @@ namespace Synet
         {
             if ((trans || size == 1) && count != 1)
             {
-                for (size_t j = 0; j < size; ++j)
+                ParallelFor(0, size, [&](size_t begin, size_t end)
                 {
-                    for (size_t i = 0; i < count; ++i)
-                        dst[i] = FusedLayerForward0(src[i] + bias[i], scale[i]);
-                    src += count;
-                    dst += count;
-                }
+                    for (size_t j = begin; j < end; ++j)
+                    {
+                        const T * ps = src + j * count;
+                        T * pd = dst + j * count;
+                        for (size_t i = 0; i < count; ++i)
+                            pd[i] = FusedLayerForward0(ps[i] + bias[i], scale[i]);
+                    }
+                }, ParallelGrain(count));
             }
             else
             {
-                for (size_t i = 0; i < count; ++i)
+                ParallelFor(0, count, [&](size_t begin, size_t end)
                 {
-                    for (size_t j = 0; j < size; ++j)
-                        dst[j] = FusedLayerForward0(src[j] + bias[i], scale[i]);
-                    src += size;
-                    dst += size;
-                }
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const T * ps = src + i * size;
+                        T * pd = dst + i * size;
+                        for (size_t j = 0; j < size; ++j)
+                            pd[j] = FusedLayerForward0(ps[j] + bias[i], scale[i]);
+                    }
+                }, ParallelGrain(size));
             }
         }
 
@@ -70,23 +77,29 @@ namespace Synet
         {
             if ((trans || size == 1) && count != 1)
             {
-                for (size_t j = 0; j < size; ++j)
+                ParallelFor(0, size, [&](size_t begin, size_t end)
                 {
-                    for (size_t i = 0; i < count; ++i)
-                        dst[i] = FusedLayerForward1(src[i] + bias0[i], scale1[i], bias1[i]);
-                    src += count;
-                    dst += count;
-                }
+                    for (size_t j = begin; j < end; ++j)
+                    {
+                        const T * ps = src + j * count;
+                        T * pd = dst + j * count;
+                        for (size_t i = 0; i < count; ++i)
+                            pd[i] = FusedLayerForward1(ps[i] + bias0[i], scale1[i], bias1[i]);
+                    }
+                }, ParallelGrain(count));
             }
             else
             {
-                for (size_t i = 0; i < count; ++i)
+                ParallelFor(0, count, [&](size_t begin, size_t end)
                 {
-                    for (size_t j = 0; j < size; ++j)
-                        dst[j] = FusedLayerForward1(src[j] + bias0[i], scale1[i], bias1[i]);
-                    src += size;
-                    dst += size;
-                }
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const T * ps = src + i * size;
+                        T * pd = dst + i * size;
+                        for (size_t j = 0; j < size; ++j)
+                            pd[j] = FusedLayerForward1(ps[j] + bias0[i], scale1[i], bias1[i]);
+                    }
+                }, ParallelGrain(size));
             }
         }
 
@@ -100,23 +113,29 @@ namespace Synet
         {
             if ((trans || size == 1) && count != 1)
             {
-                for (size_t j = 0; j < size; ++j)
+                ParallelFor(0, size, [&](size_t begin, size_t end)
                 {
-                    for (size_t i = 0; i < count; ++i)
-                        dst[i] = FusedLayerForward2(src[i], scale[i], bias[i], slope[0]);
-                    src += count;
-                    dst += count;
-                }
+                    for (size_t j = begin; j < end; ++j)
+                    {
+                        const T * ps = src + j * count;
+                        T * pd = dst + j * count;
+                        for (size_t i = 0; i < count; ++i)
+                            pd[i] = FusedLayerForward2(ps[i], scale[i], bias[i], slope);
+                    }
+                }, ParallelGrain(count));
             }
             else
             {
-                for (size_t i = 0; i < count; ++i)
+                ParallelFor(0, count, [&](size_t begin, size_t end)
                 {
-                    for (size_t j = 0; j < size; ++j)
-                        dst[j] = FusedLayerForward2(src[j], scale[i], bias[i], slope[0]);
-                    src += size;
-                    dst += size;
-                }
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const T * ps = src + i * size;
+                        T * pd = dst + i * size;
+                        for (size_t j = 0; j < size; ++j)
+                            pd[j] = FusedLayerForward2(ps[j], scale[i], bias[i], slope);
+                    }
+                }, ParallelGrain(size));
             }
         }
 
@@ -129,23 +148,29 @@ namespace Synet
         {
             if ((trans || size == 1) && count != 1)
             {
-                for (size_t j = 0; j < size; ++j)
+                ParallelFor(0, size, [&](size_t begin, size_t end)
                 {
-                    for (size_t i = 0; i < count; ++i)
-                        dst[i] = FusedLayerForward3(src[i] + bias[i], scale[i]);
-                    src += count;
-                    dst += count;
-                }
+                    for (size_t j = begin; j < end; ++j)
+                    {
+                        const T * ps = src + j * count;
+                        T * pd = dst + j * count;
+                        for (size_t i = 0; i < count; ++i)
+                            pd[i] = FusedLayerForward3(ps[i] + bias[i], scale[i]);
+                    }
+                }, ParallelGrain(count));
             }
             else
             {
-                for (size_t i = 0; i < count; ++i)
+                ParallelFor(0, count, [&](size_t begin, size_t end)
                 {
-                    for (size_t j = 0; j < size; ++j)
-                        dst[j] = FusedLayerForward3(src[j] + bias[i], scale[i]);
-                    src += size;
-                    dst += size;
-                }
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const T * ps = src + i * size;
+                        T * pd = dst + i * size;
+                        for (size_t j = 0; j < size; ++j)
+                            pd[j] = FusedLayerForward3(ps[j] + bias[i], scale[i]);
+                    }
+                }, ParallelGrain(size));
             }
         }
 
@@ -153,33 +178,37 @@ namespace Synet
         {
             if ((trans || size == 1) && count != 1)
             {
-                for (size_t j = 0; j < size; ++j)
+                ParallelFor(0, size, [&](size_t begin, size_t end)
                 {
-                    for (size_t i = 0; i < count; ++i)
+                    for (size_t j = begin; j < end; ++j)
                     {
-                        T x = src[i] + bias0[i];
-                        dst[i] = std::max((T)0, x);
-                        dst[i + count] = std::max((T)0, x*scale1[0] + bias1[0]);
+                        const T * ps = src + j * count;
+                        T * pd = dst + j * 2 * count;
+                        for (size_t i = 0; i < count; ++i)
+                        {
+                            T x = ps[i] + bias0[i];
+                            pd[i] = std::max((T)0, x);
+                            pd[i + count] = std::max((T)0, x*scale1[0] + bias1[0]);
+                        }
                     }
-                    src += count;
-                    dst += 2 * count;
-                }
+                }, ParallelGrain(count));
             }
             else
             {
-                T * dst0 = dst, * dst1 = dst + count*size;
-                for (size_t i = 0; i < count; ++i)
+                ParallelFor(0, count, [&](size_t begin, size_t end)
                 {
-                    for (size_t j = 0; j < size; ++j)
+                    for (size_t i = begin; i < end; ++i)
                     {
-                        T x = src[j] + bias0[i];
-                        dst0[j] = std::max((T)0, x);
-                        dst1[j] = std::max((T)0, x*scale1[0] + bias1[0]);
+                        const T * ps = src + i * size;
+                        T * dst0 = dst + i * size, * dst1 = dst + (count + i) * size;
+                        for (size_t j = 0; j < size; ++j)
+                        {
+                            T x = ps[j] + bias0[i];
+                            dst0[j] = std::max((T)0, x);
+                            dst1[j] = std::max((T)0, x*scale1[0] + bias1[0]);
+                        }
                     }
-                    src += size;
-                    dst0 += size;
-                    dst1 += size;
-                }
+                }, ParallelGrain(size));
             }
         }
 
@@ -192,25 +221,29 @@ namespace Synet
         {
             if ((trans || size == 1) && count != 1)
             {
-                for (size_t j = 0; j < size; ++j)
+                ParallelFor(0, size, [&](size_t begin, size_t end)
                 {
-                    for (size_t i = 0; i < count; ++i)
-                        dst[i] = FusedLayerForward8(src0[i], src1[i], src2[i]);
-                    src0 += count;
-                    src1 += count;
-                    dst += count;
-                }
+                    for (size_t j = begin; j < end; ++j)
+                    {
+                        const T * ps0 = src0 + j * count, * ps1 = src1 + j * count;
+                        T * pd = dst + j * count;
+                        for (size_t i = 0; i < count; ++i)
+                            pd[i] = FusedLayerForward8(ps0[i], ps1[i], src2[i]);
+                    }
+                }, ParallelGrain(count));
             }
             else
             {
-                for (size_t i = 0; i < count; ++i)
+                ParallelFor(0, count, [&](size_t begin, size_t end)
                 {
-                    for (size_t j = 0; j < size; ++j)
-                        dst[j] = FusedLayerForward8(src0[j], src1[j], src2[i]);
-                    src0 += size;
-                    src1 += size;
-                    dst += size;
-                }
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const T * ps0 = src0 + i * size, * ps1 = src1 + i * size;
+                        T * pd = dst + i * size;
+                        for (size_t j = 0; j < size; ++j)
+                            pd[j] = FusedLayerForward8(ps0[j], ps1[j], src2[i]);
+                    }
+                }, ParallelGrain(size));
             }
         }
 
@@ -223,53 +256,46 @@ namespace Synet
         {
             const T * scale1 = scale0 + count0;
             const T * bias1 = bias0 + count0;
+            size_t count = count0 + count1;
             if (trans || size == 1)
             {
-                if (dst1)
-                {
-                    for (size_t j = 0; j < size; ++j)
-                    {
-                        for (size_t i = 0; i < count0; ++i)
-                            dst0[i] = FusedLayerForward9(src0[i], scale0[i], bias0[i]), dst1[i] = src0[i];
-                        src0 += count0, dst0 += count0, dst1 += count0;
-                        for (size_t i = 0; i < count1; ++i)
-                            dst0[i] = FusedLayerForward9(src1[i], scale1[i], bias1[i]), dst1[i] = src1[i];
-                        src1 += count1, dst0 += count1, dst1 += count1;
-                    }
-                }
-                else
+                ParallelFor(0, size, [&](size_t begin, size_t end)
                 {
-                    for (size_t j = 0; j < size; ++j)
+                    for (size_t j = begin; j < end; ++j)
                     {
+                        const T * ps0 = src0 + j * count0, * ps1 = src1 + j * count1;
+                        T * pd0 = dst0 + j * count, * pd1 = dst1 ? dst1 + j * count : NULL;
                         for (size_t i = 0; i < count0; ++i)
-                            dst0[i] = FusedLayerForward9(src0[i], scale0[i], bias0[i]);
-                        src0 += count0, dst0 += count0;
+                            pd0[i] = FusedLayerForward9(ps0[i], scale0[i], bias0[i]);
                         for (size_t i = 0; i < count1; ++i)
-                            dst0[i] = FusedLayerForward9(src1[i], scale1[i], bias1[i]);
-                        src1 += count1, dst0 += count1;
+                            pd0[count0 + i] = FusedLayerForward9(ps1[i], scale1[i], bias1[i]);
+                        if (pd1)
+                        {
+                            for (size_t i = 0; i < count0; ++i)
+                                pd1[i] = ps0[i];
+                            for (size_t i = 0; i < count1; ++i)
+                                pd1[count0 + i] = ps1[i];
+                        }
                     }
-                }
+                }, ParallelGrain(count));
             }
             else
             {
-                if (dst1)
-                {
-                    for (size_t i = 0; i < count0; ++i, src0 += size, dst0 += size, dst1 += size)
-                        for (size_t j = 0; j < size; ++j)
-                            dst0[j] = FusedLayerForward9(src0[j], scale0[i], bias0[i]), dst1[j] = src0[j];
-                    for (size_t i = 0; i < count1; ++i, src1 += size, dst0 += size, dst1 += size)
-                        for (size_t j = 0; j < size; ++j)
-                            dst0[j] = FusedLayerForward9(src1[j], scale1[i], bias1[i]), dst1[j] = src1[j];
-                }
-                else
+                ParallelFor(0, count, [&](size_t begin, size_t end)
                 {
-                    for (size_t i = 0; i < count0; ++i, src0 += size, dst0 += size)
-                        for (size_t j = 0; j < size; ++j)
-                            dst0[j] = FusedLayerForward9(src0[j], scale0[i], bias0[i]);
-                    for (size_t i = 0; i < count1; ++i, src1 += size, dst0 += size)
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const T * ps = i < count0 ? src0 + i * size : src1 + (i - count0) * size;
+                        T * pd0 = dst0 + i * size, * pd1 = dst1 ? dst1 + i * size : NULL;
                         for (size_t j = 0; j < size; ++j)
-                            dst0[j] = FusedLayerForward9(src1[j], scale1[i], bias1[i]);
-                }
+                            pd0[j] = FusedLayerForward9(ps[j], scale0[i], bias0[i]);
+                        if (pd1)
+                        {
+                            for (size_t j = 0; j < size; ++j)
+                                pd1[j] = ps[j];
+                        }
+                    }
+                }, ParallelGrain(size));
             }
         }
 
@@ -280,8 +306,11 @@ namespace Synet
 
         template <class T> void FusedLayerForwardCpu11(const T * src, size_t size, const T * params, T * dst)
         {
-            for (size_t i = 0; i < size; ++i)
-                dst[i] = FusedLayerForward11(src[i], params[0], params[1], params[2], params[3]);
+            ParallelFor(0, size, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                    dst[i] = FusedLayerForward11(src[i], params[0], params[1], params[2], params[3]);
+            }, PARALLEL_MIN_WORK);
         }
 
 #ifdef SYNET_SIMD_LIBRARY_ENABLE
@@ -35,7 +35,9 @@ namespace Synet
         template <class T> void LogLayerForwardCpu(const T * src, size_t size, T scale, T shift, T base, T * dst)
         {
             for (size_t i = 0; i < size; ++i)
-                dst[i] = ::log(src[i] * scale + shift)*base;
+                dst[i] = src[i] * scale + shift;
+            CpuLog(dst, size, dst);
+            CpuScale(dst, size, base, dst);
         }
     }
 
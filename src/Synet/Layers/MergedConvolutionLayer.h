@@ -27,7 +27,9 @@
 #include "Synet/Common.h"
 #include "Synet/Layer.h"
 #include "Synet/Utils/MergedConvolution.h"
+#include "Synet/Utils/Activation.h"
 #include "Synet/Layers/HswishLayer.h"
+#include "Synet/Layers/PreluLayer.h"
 
 namespace Synet
 {
@@ -96,22 +98,22 @@ namespace Synet
 
         template<class T, int update> struct Update
         {
-            static void Func(T * ptr, T val);
+            static T Func(const T * ptr, T val);
         };
 
         template<class T> struct Update<T, 0>
         {
-            static SYNET_INLINE void Func(T * ptr, T val)
+            static SYNET_INLINE T Func(const T * ptr, T val)
             {
-                *ptr = val;
+                return val;
             }
         };
 
         template<class T> struct Update<T, 1>
         {
-            static SYNET_INLINE void Func(T * ptr, T val)
+            static SYNET_INLINE T Func(const T * ptr, T val)
             {
-                *ptr += val;
+                return *ptr + val;
             }
         };
 
@@ -151,7 +153,7 @@ namespace Synet
                         }
                     }
                     for (size_t dc = 0; dc < conv.dstC; ++dc)
-                        Update<T, update>::Func(dst + dc, Activation<T, activation>::Func(buf[dc], params, dc));
+                        dst[dc] = Activation<T, activation>::Func(Update<T, update>::Func(dst + dc, buf[dc]), params, dc);
                     dst += conv.dstC;
                 }
             }
@@ -332,7 +334,10 @@ namespace Synet
             if(_add)
                 assert(_srcSize == _dstSize);
 
-            _mergedConvolution32f.Init(_num, _conv, Detail::MCC, _add);
+            ConvParam convs[Detail::MCC] = { _conv[0], _conv[1], _conv[2] };
+            if (_add)
+                convs[2].activation = ActivationFunctionTypeIdentity;
+            _mergedConvolution32f.Init(_num, convs, Detail::MCC, _add);
             if (_mergedConvolution32f.Enable())
             {
                 buf[0]->Extend({ _mergedConvolution32f.ExternalBufferSize() });
@@ -357,7 +362,7 @@ namespace Synet
             return Base::MemoryUsage() + _mergedConvolution32f.InternalBufferSize() * sizeof(Type);
         }
 
-        virtual void CompactWeight()
+        virtual void CompactWeight(bool keepSource)
         {
             for(size_t i = 0; i < Detail::MCC; ++i)
                 if (_internal[i])
@@ -374,7 +379,11 @@ namespace Synet
         void ForwardCpu(const T * src, T * buf, T * dst)
         {
             if (_mergedConvolution32f.Enable())
+            {
                 _mergedConvolution32f.Forward(src, buf, dst);
+                if (_add)
+                    Activate(dst, _num * _dstSize);
+            }
             else
             {
                 T * buf1 = buf + _conv[0].dstC * _conv[0].dstH * _conv[0].dstW;
@@ -391,6 +400,35 @@ namespace Synet
             }
         }
 
+        void Activate(T * dst, size_t size)
+        {
+            switch (_conv[2].activation)
+            {
+            case ActivationFunctionTypeIdentity:
+                break;
+            case ActivationFunctionTypeRelu:
+                CpuRelu(dst, size, 0.0f, dst);
+                break;
+            case ActivationFunctionTypeLeakyRelu:
+                CpuRelu(dst, size, _params[2][0], dst);
+                break;
+            case ActivationFunctionTypeRestrictRange:
+                CpuRestrictRange(dst, size, _params[2][0], _params[2][1], dst);
+                break;
+            case ActivationFunctionTypePrelu:
+                Detail::PreluLayerForwardCpu(dst, _params[2], _conv[2].dstC, size / _conv[2].dstC, dst, 1);
+                break;
+            case ActivationFunctionTypeElu:
+                CpuElu(dst, size, _params[2][0], dst);
+                break;
+            case ActivationFunctionTypeHswish:
+                Detail::HswishLayerForwardCpu(dst, size, _params[2][0], _params[2][1], dst);
+                break;
+            default:
+                assert(0);
+            }
+        }
+
     private:
         bool _biasTerm[Detail::MCC];
         int _internal[Detail::MCC], _add;
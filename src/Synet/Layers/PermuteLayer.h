@@ -27,6 +27,7 @@
 #include "Synet/Common.h"
 #include "Synet/Layer.h"
 #include "Synet/Utils/Math.h"
+#include "Synet/Utils/Permute.h"
 
 namespace Synet
 {
@@ -52,7 +53,7 @@ namespace Synet
             _permute = false;
             _order = param.order();
             _count = _order.size();
-            assert(_count >= 2 && _count <= 4);
+            assert(_count >= 2 && _count <= PERMUTE_DIM_MAX);
             size_t is = 0, os = 0;
             for (size_t i = 0; i < _order.size(); ++i)
             {
@@ -70,17 +71,6 @@ namespace Synet
                 _dstShape.clear();
                 for (size_t i = 0; i < _count; ++i)
                     _dstShape.push_back(_srcShape[_order[i]]);
-                _srcStride.resize(_count, 1);
-                _dstStride.resize(_count, 1);
-                Shape dstStride(_count, 1);
-                for (ptrdiff_t i = _count - 2; i >= 0; i--)
-                {
-                    _srcStride[i] = _srcStride[i + 1] * _srcShape[i + 1];
-                    dstStride[i] = dstStride[i + 1] * _dstShape[i + 1];
-                }
-                for (size_t i = 0; i < _count; ++i)
-                    _dstStride[_order[i]] = dstStride[i];
-
                 dst[0]->Reshape(_dstShape, param.format() == TensorFormatUnknown ? src[0]->Format() : param.format());
             }
             else
@@ -93,61 +83,13 @@ namespace Synet
             if (_permute)
             {
                 SYNET_PERF_FUNC();
-                const Type * pSrc = src[0]->CpuData();
-                Type * pDst = dst[0]->CpuData();
-                switch (_count)
-                {
-                case 2:
-                    for (size_t i = 0; i < _srcShape[0]; ++i)
-                    {
-                        for (size_t j = 0; j < _srcShape[1]; ++j)
-                        {
-                            size_t srcOffset = i*_srcStride[0] + j*_srcStride[1];
-                            size_t dstOffset = i*_dstStride[0] + j*_dstStride[1];
-                            pDst[dstOffset] = pSrc[srcOffset];
-                        }
-                    }
-                    break;
-                case 3:
-                    for (size_t i = 0; i < _srcShape[0]; ++i)
-                    {
-                        for (size_t j = 0; j < _srcShape[1]; ++j)
-                        {
-                            for (size_t k = 0; k < _srcShape[2]; ++k)
-                            {
-                                size_t srcOffset = i*_srcStride[0] + j*_srcStride[1] + k*_srcStride[2];
-                                size_t dstOffset = i*_dstStride[0] + j*_dstStride[1] + k*_dstStride[2];
-                                pDst[dstOffset] = pSrc[srcOffset];
-                            }
-                        }
-                    }
-                    break;
-                case 4:
-                    for (size_t i = 0; i < _srcShape[0]; ++i)
-                    {
-                        for (size_t j = 0; j < _srcShape[1]; ++j)
-                        {
-                            for (size_t k = 0; k < _srcShape[2]; ++k)
-                            {
-                                for (size_t l = 0; l < _srcShape[3]; ++l)
-                                {
-                                    size_t srcOffset = i*_srcStride[0] + j*_srcStride[1] + k*_srcStride[2] + l*_srcStride[3];
-                                    size_t dstOffset = i*_dstStride[0] + j*_dstStride[1] + k*_dstStride[2] + l*_dstStride[3];
-                                    pDst[dstOffset] = pSrc[srcOffset];
-                                }
-                            }
-                        }
-                    }
-                    break;
-                default:
-                    assert(0);
-                }
+                CpuPermute(src[0]->CpuData(), _srcShape, _order, dst[0]->CpuData());
             }
         }
 
     private:
         bool _permute;
         size_t _count;
-        Shape _order, _srcShape, _dstShape, _srcStride, _dstStride;
+        Shape _order, _srcShape, _dstShape;
     };
 }
\ No newline at end of file
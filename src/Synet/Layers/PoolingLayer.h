@@ -27,6 +27,7 @@
 #include "Synet/Common.h"
 #include "Synet/Layer.h"
 #include "Synet/Utils/Math.h"
+#include "Synet/Utils/Parallel.h"
 
 namespace Synet
 {
@@ -37,55 +38,62 @@ namespace Synet
         {
             if (trans)
             {
-                for (size_t ph = 0; ph < dstH; ++ph)
+                ParallelFor(0, dstH, [&](size_t begin, size_t end)
                 {
-                    size_t hStart = ph * strideY - padY;
-                    size_t hEnd = std::min(hStart + kernelY, srcH);
-                    hStart = std::max<ptrdiff_t>(0, hStart);
-                    for (size_t pw = 0; pw < dstW; ++pw)
+                    T * pd = dst + begin * dstW * channels;
+                    for (size_t ph = begin; ph < end; ++ph)
                     {
-                        size_t wStart = pw * strideX - padX;
-                        size_t wEnd = std::min(wStart + kernelX, srcW);
-                        wStart = std::max<ptrdiff_t>(0, wStart);
-                        for (size_t c = 0; c < channels; ++c)
-                            dst[c] = std::numeric_limits<T>::lowest();
-                        for (size_t h = hStart; h < hEnd; ++h)
+                        size_t hStart = ph * strideY - padY;
+                        size_t hEnd = std::min(hStart + kernelY, srcH);
+                        hStart = std::max<ptrdiff_t>(0, hStart);
+                        for (size_t pw = 0; pw < dstW; ++pw)
                         {
-                            for (size_t w = wStart; w < wEnd; ++w)
+                            size_t wStart = pw * strideX - padX;
+                            size_t wEnd = std::min(wStart + kernelX, srcW);
+                            wStart = std::max<ptrdiff_t>(0, wStart);
+                            for (size_t c = 0; c < channels; ++c)
+                                pd[c] = std::numeric_limits<T>::lowest();
+                            for (size_t h = hStart; h < hEnd; ++h)
                             {
-                                const T * pc = src + (h * srcW + w)*channels;
-                                for (size_t c = 0; c < channels; ++c)
-                                    dst[c] = std::max(dst[c], pc[c]);
+                                for (size_t w = wStart; w < wEnd; ++w)
+                                {
+                                    const T * pc = src + (h * srcW + w)*channels;
+                                    for (size_t c = 0; c < channels; ++c)
+                                        pd[c] = std::max(pd[c], pc[c]);
+                                }
                             }
+                            pd += channels;
                         }
-                        dst += channels;
                     }
-                }
+                }, ParallelGrain(dstW * channels * kernelY * kernelX));
             }
             else
             {
-                for (size_t c = 0; c < channels; ++c)
+                ParallelFor(0, channels, [&](size_t begin, size_t end)
                 {
-                    for (size_t ph = 0; ph < dstH; ++ph)
+                    for (size_t c = begin; c < end; ++c)
                     {
-                        size_t hStart = ph * strideY - padY;
-                        size_t hEnd = std::min(hStart + kernelY, srcH);
-                        hStart = std::max<ptrdiff_t>(0, hStart);
-                        for (size_t pw = 0; pw < dstW; ++pw)
+                        const T * ps = src + c * srcW * srcH;
+                        T * pd = dst + c * dstW * dstH;
+                        for (size_t ph = 0; ph < dstH; ++ph)
                         {
-                            size_t wStart = pw * strideX - padX;
-                            size_t wEnd = std::min(wStart + kernelX, srcW);
-                            wStart = std::max<ptrdiff_t>(0, wStart);
-                            T max = std::numeric_limits<T>::lowest();
-                            for (size_t h = hStart; h < hEnd; ++h)
-                                for (size_t w = wStart; w < wEnd; ++w)
-                                    max = std::max(max, src[h * srcW + w]);
-                            dst[ph*dstW + pw] = max;
+                            size_t hStart = ph * strideY - padY;
+                            size_t hEnd = std::min(hStart + kernelY, srcH);
+                            hStart = std::max<ptrdiff_t>(0, hStart);
+                            for (size_t pw = 0; pw < dstW; ++pw)
+                            {
+                                size_t wStart = pw * strideX - padX;
+                                size_t wEnd = std::min(wStart + kernelX, srcW);
+                                wStart = std::max<ptrdiff_t>(0, wStart);
+                                T max = std::numeric_limits<T>::lowest();
+                                for (size_t h = hStart; h < hEnd; ++h)
+                                    for (size_t w = wStart; w < wEnd; ++w)
+                                        max = std::max(max, ps[h * srcW + w]);
+                                pd[ph*dstW + pw] = max;
+                            }
                         }
                     }
-                    src += srcW * srcH;
-                    dst += dstW * dstH;
-                }            
+                }, ParallelGrain(dstW * dstH * kernelY * kernelX));
             }
         }
 
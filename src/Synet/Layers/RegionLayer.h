@@ -80,14 +80,14 @@ namespace Synet
             this->UsePerfStat();
         }
 
-        void GetRegions(const TensorPtrs & src, Type threshold, Regions & dst)
+        void GetRegions(const TensorPtrs & src, Type threshold, Regions & dst, size_t b = 0)
         {
             SYNET_PERF_FUNC();
             dst.clear();
-            const Type * pPredict = src[0]->CpuData();
             size_t height = src[0]->Axis(2);
             size_t width = src[0]->Axis(3);
             size_t outputs = src[0]->Size(1);
+            const Type * pPredict = src[0]->CpuData() + b * outputs;
             for (size_t i = 0; i < width*height; ++i) 
             {
                 size_t row = i / height;
@@ -143,12 +143,13 @@ namespace Synet
 
             if (_softmax) 
             {
+                Type buffer;
                 for (size_t b = 0; b < batch; ++b) 
                 {
                     for (size_t i = 0; i < height*width*_num; ++i)
                     {
                         size_t index = size*i + b*outputs;
-                        Detail::SoftmaxLayerForwardCpu(pDst + index + 5, 1, _classes, 1, pDst + index + 5);
+                        Detail::SoftmaxLayerForwardCpu(pDst + index + 5, 1, _classes, 1, &buffer, pDst + index + 5);
                     }
                 }
             }
@@ -27,64 +27,10 @@
 #include "Synet/Common.h"
 #include "Synet/Layer.h"
 #include "Synet/Utils/Math.h"
+#include "Synet/Utils/Permute.h"
 
 namespace Synet
 {
-    namespace Detail
-    {
-        template< class T> void ReorgLayerForwardCpu(const T * src, size_t batch, size_t channels, size_t height, size_t width, size_t stride, int forward, int trans, T * dst)
-        {
-            size_t out_c = channels / (stride*stride);
-            for (size_t b = 0; b < batch; ++b)
-            {
-                if(trans)
-                {
-                    for (size_t j = 0; j < height; ++j)
-                    {
-                        for (size_t i = 0; i < width; ++i)
-                        {
-                            for (size_t k = 0; k < channels; ++k)
-                            {
-                                size_t src_index = k + channels*(i + width*(j + height*b));
-                                size_t c2 = k % out_c;
-                                size_t offset = k / out_c;
-                                size_t w2 = i*stride + offset % stride;
-                                size_t h2 = j*stride + offset / stride;
-                                size_t dst_index = c2 + out_c*(w2 + width*stride*(h2 + height*stride*b));
-                                if (forward)
-                                    dst[dst_index] = src[src_index];
-                                else
-                                    dst[src_index] = src[dst_index];
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    for (size_t k = 0; k < channels; ++k)
-                    {
-                        for (size_t j = 0; j < height; ++j)
-                        {
-                            for (size_t i = 0; i < width; ++i)
-                            {
-                                size_t src_index = i + width*(j + height*(k + channels*b));
-                                size_t c2 = k % out_c;
-                                size_t offset = k / out_c;
-                                size_t w2 = i*stride + offset % stride;
-                                size_t h2 = j*stride + offset / stride;
-                                size_t dst_index = w2 + width*stride*(h2 + height*stride*(c2 + out_c*b));
-                                if (forward) 
-                                    dst[dst_index] = src[src_index];
-                                else 
-                                    dst[src_index] = src[dst_index];
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-
     template <class T> class ReorgLayer : public Synet::Layer<T>
     {
     public:
@@ -136,21 +82,32 @@ namespace Synet
                 }
             }
             dst[0]->Reshape(shape, src[0]->Format());
+            
+            size_t b = shape[0], s = _stride;
+            if (_trans)
+            {
+                size_t h = shape[1], w = shape[2], c = shape[3] / (s*s);
+                _shape = _reverse ? Shape({ b, h, w, s, s, c }) : Shape({ b, h, s, w, s, c });
+                _order = Shape({ 0, 1, 3, 2, 4, 5 });
+            }
+            else
+            {
+                size_t c = shape[1] / (s*s), h = shape[2], w = shape[3];
+                _shape = _reverse ? Shape({ b, s, s, c, h, w }) : Shape({ b, c, h, s, w, s });
+                _order = _reverse ? Shape({ 0, 3, 4, 1, 5, 2 }) : Shape({ 0, 3, 5, 1, 2, 4 });
+            }
             this->UsePerfStat();
         }
 
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
-            const Shape & shape = dst[0]->Shape();
-            if(_trans)
-                Detail::ReorgLayerForwardCpu(src[0]->CpuData(), shape[0], shape[3], shape[1], shape[2], _stride, _reverse, _trans, dst[0]->CpuData());
-            else
-                Detail::ReorgLayerForwardCpu(src[0]->CpuData(), shape[0], shape[1], shape[2], shape[3], _stride, _reverse, _trans, dst[0]->CpuData());
+            CpuPermute(src[0]->CpuData(), _shape, _order, dst[0]->CpuData());
         }
 
     private:
         size_t _stride;
         int _reverse, _trans;
+        Shape _shape, _order;
     };
 }
\ No newline at end of file
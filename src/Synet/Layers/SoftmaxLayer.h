@@ -33,10 +33,8 @@ namespace Synet
 {
     namespace Detail
     {
-        template <typename T> void SoftmaxLayerForwardCpu(const T * src, size_t outer, size_t count, size_t inner, T * dst)
+        template <typename T> void SoftmaxLayerForwardCpu(const T * src, size_t outer, size_t count, size_t inner, T * buffer, T * dst)
         {
-            Synet::Tensor<T> _buffer({ inner });
-            T * buffer = _buffer.CpuData();
             for (size_t o = 0; o < outer; ++o)
             {
                 Synet::CpuCopy(src, inner, buffer);
@@ -78,7 +76,7 @@ namespace Synet
         }
 
 #ifdef SYNET_SIMD_LIBRARY_ENABLE
-        template <> SYNET_INLINE void SoftmaxLayerForwardCpu<float>(const float * src, size_t outer, size_t count, size_t inner, float * dst)
+        template <> SYNET_INLINE void SoftmaxLayerForwardCpu<float>(const float * src, size_t outer, size_t count, size_t inner, float * buffer, float * dst)
         {
             ::SimdSynetSoftmaxLayerForward(src, outer, count, inner, dst);
         }
@@ -104,6 +102,7 @@ namespace Synet
             _outer = src[0]->Size(0, _axis);
             _count = src[0]->Axis(_axis);
             _inner = src[0]->Size(_axis + 1);
+            _buffer.Reshape({ _inner });
             dst[0]->Reshape(src[0]->Shape(), src[0]->Format());
             this->UsePerfStat();
         }
@@ -111,10 +110,11 @@ namespace Synet
     protected:
         virtual void ForwardCpu(const TensorPtrs & src, const TensorPtrs & buf, const TensorPtrs & dst)
         {
-            Detail::SoftmaxLayerForwardCpu(src[0]->CpuData(), _outer, _count, _inner, dst[0]->CpuData());
+            Detail::SoftmaxLayerForwardCpu(src[0]->CpuData(), _outer, _count, _inner, _buffer.CpuData(), dst[0]->CpuData());
         }
 
     private:
         size_t _outer, _count, _inner, _axis;
+        Tensor _buffer;
     };
 }
\ No newline at end of file
@@ -26,6 +26,7 @@
 
 #include "Synet/Common.h"
 #include "Synet/Layer.h"
+#include "Synet/Utils/Activation.h"
 
 namespace Synet
 {
@@ -40,12 +41,10 @@ namespace Synet
                     dst[i] = ::abs(src[i]);
                 break;
             case UnaryOperationTypeExp:
-                for (size_t i = 0; i < size; ++i)
-                    dst[i] = ::exp(src[i]);
+                CpuExp(src, size, dst);
                 break;
             case UnaryOperationTypeLog:
-                for (size_t i = 0; i < size; ++i)
-                    dst[i] = ::log(src[i]);
+                CpuLog(src, size, dst);
                 break;
             case UnaryOperationTypeNeg:
                 for (size_t i = 0; i < size; ++i)
@@ -60,8 +59,7 @@ namespace Synet
                     dst[i] = ::sqrt(src[i]);
                 break;
             case UnaryOperationTypeTanh:
-                for (size_t i = 0; i < size; ++i)
-                    dst[i] = ::tanh(src[i]);
+                CpuTanh(src, size, dst);
                 break;
             case UnaryOperationTypeZero:
                 ::memset(dst, 0, size * sizeof(T));
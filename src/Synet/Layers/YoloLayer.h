@@ -56,37 +56,48 @@ namespace Synet
             for (size_t i = 0; i < param.mask().size(); ++i)
                 _mask[i] = param.mask()[i];            
             
-            Shape dstShape = src[0]->Shape();
-            dstShape[1] = _num*(_classes + 4 + 1);
-            dst[0]->Reshape(dstShape);
+            if (param.fused())
+            {
+                assert(src[0]->Axis(1) == _num*(_classes + 4 + 1));
+                if (dst[0] != src[0])
+                    dst[0]->Share(*src[0]);
+            }
+            else
+            {
+                Shape dstShape = src[0]->Shape();
+                dstShape[1] = _num*(_classes + 4 + 1);
+                dst[0]->Reshape(dstShape);
+            }
             this->UsePerfStat();
         }
 
-        void GetRegions(const TensorPtrs & src, size_t netW, size_t netH, Type threshold, Regions & dst) const
+        void GetRegions(const TensorPtrs & src, size_t netW, size_t netH, Type threshold, Regions & dst, size_t b = 0) const
         {
             SYNET_PERF_FUNC();
             dst.clear();
-            size_t b = 0;
-            size_t layerW = src[0]->Axis(2);
-            size_t layerH = src[0]->Axis(3);
+            size_t layerH = src[0]->Axis(2);
+            size_t layerW = src[0]->Axis(3);
+            size_t area = layerH * layerW, step = (_classes + 5) * area;
+            const Type * data = src[0]->CpuData({ b, 0, 0, 0 });
             for (size_t y = 0; y < layerH; ++y)
             {
                 for (size_t x = 0; x < layerW; ++x)
                 {
-                    for (size_t n = 0; n < _num; ++n)
+                    const Type * cell = data + y * layerW + x;
+                    for (size_t n = 0; n < _num; ++n, cell += step)
                     {
-                        Type objectness = src[0]->CpuData({ b, n*(_classes + 5) + 4, y, x })[0];
+                        Type objectness = cell[4 * area];
                         if (objectness > threshold)
                         {
                             Region region;
-                            region.x = (x + src[0]->CpuData({ b, n*(_classes + 5) + 0, y, x })[0]) / layerW;
-                            region.y = (y + src[0]->CpuData({ b, n*(_classes + 5) + 1, y, x })[0]) / layerH;
-                            region.w = ::exp(src[0]->CpuData({ b, n*(_classes + 5) + 2, y, x })[0])*_anchors[2*_mask[n] + 0] / netW;
-                            region.h = ::exp(src[0]->CpuData({ b, n*(_classes + 5) + 3, y, x })[0])*_anchors[2*_mask[n] + 1] / netH;
+                            region.x = (x + cell[0 * area]) / layerW;
+                            region.y = (y + cell[1 * area]) / layerH;
+                            region.w = ::exp(cell[2 * area])*_anchors[2*_mask[n] + 0] / netW;
+                            region.h = ::exp(cell[3 * area])*_anchors[2*_mask[n] + 1] / netH;
                             for (size_t i = 0; i < _classes; ++i)
                             {
                                 region.id = i;
-                                region.prob = objectness*src[0]->CpuData({ b, n*(_classes + 5) + 5 + i, y, x })[0];
+                                region.prob = objectness*cell[(5 + i) * area];
                                 if (region.prob > threshold)
                                     dst.push_back(region);
                             }
@@ -109,7 +120,8 @@ namespace Synet
                     index[1] = n*(_classes + 4 + 1);
                     CpuSigmoid(src[0]->CpuData(index), 2 * area, dst[0]->CpuData(index));
                     index[1] += 2;
-                    CpuCopy(src[0]->CpuData(index), 2 * area, dst[0]->CpuData(index));
+                    if (src[0]->CpuData() != dst[0]->CpuData())
+                        CpuCopy(src[0]->CpuData(index), 2 * area, dst[0]->CpuData(index));
                     index[1] += 2;
                     CpuSigmoid(src[0]->CpuData(index), (_classes + 1) * area, dst[0]->CpuData(index));
                 }
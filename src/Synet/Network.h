@@ -82,9 +82,51 @@
 #include "Synet/Layers/YoloLayer.h"
 
 #include "Synet/Utils/SetInput.h"
+#include "Synet/Utils/Executor.h"
+#include "Synet/Utils/MemoryMap.h"
+#include "Synet/Utils/Calibration.h"
+#include "Synet/Utils/Tuning.h"
 
 namespace Synet
 {
+    namespace Detail
+    {
+        struct BinaryHeader
+        {
+            static const size_t ALIGN = 64;
+            static const uint32_t VERSION = 1;
+
+            char magic[8];
+            uint32_t version, typeSize, sizeSize, reserved;
+            uint64_t signature, paramOffset, paramSize, weightOffset, weightSize;
+
+            BinaryHeader(uint32_t typeSize_ = 0, uint64_t signature_ = 0)
+                : version(VERSION)
+                , typeSize(typeSize_)
+                , sizeSize(sizeof(size_t))
+                , reserved(0)
+                , signature(signature_)
+                , paramOffset(0)
+                , paramSize(0)
+                , weightOffset(0)
+                , weightSize(0)
+            {
+                memcpy(magic, "SYNETBIN", sizeof(magic));
+            }
+
+            bool Compatible(const BinaryHeader & other) const
+            {
+                return memcmp(magic, other.magic, sizeof(magic)) == 0 && version == other.version &&
+                    typeSize == other.typeSize && sizeSize == other.sizeSize && signature == other.signature;
+            }
+
+            static size_t Align(size_t size)
+            {
+                return (size + ALIGN - 1) / ALIGN * ALIGN;
+            }
+        };
+    }
+
     template <class T> class Network
     {
     public:
@@ -97,8 +139,24 @@ namespace Synet
         typedef Synet::Region<T> Region;
         typedef std::vector<Region> Regions;
 
+        struct RegionsBuffer
+        {
+            TensorPtrs dst;
+            Regions candidats, detected;
+            std::vector<Type> left, top, right, bottom, area;
+        };
+
         Network()
             : _empty(true)
+            , _shared(false)
+            , _param(new NetworkParamHolder())
+            , _naive(0)
+            , _interOp(1)
+            , _tuning(false)
+            , _keepTensors(false)
+#ifdef SYNET_ALLOCATION_CHECK
+            , _forwarded(false)
+#endif
         {
         }
 
@@ -109,54 +167,82 @@ namespace Synet
 
         const NetworkParam & Param() const 
         { 
-            return _param(); 
+            return (*_param)(); 
         }
 
-        bool Load(const String & model, const String & weight)
+        bool Load(const String & model, const String & weight, bool map = false)
         {
-            if (!_param.Load(model))
+            _param.reset(new NetworkParamHolder());
+            _map.reset();
+            _shared = false;
+            if (!_param->Load(model))
             {
                 std::cout << "Can't load model file '" << model << "' !" << std::endl;
                 return false;
             }
 
             _layers.clear();
-            for (size_t i = 0; i < _param().layers().size(); ++i)
+            for (size_t i = 0; i < (*_param)().layers().size(); ++i)
             {
-                LayerSharedPtr layer(Create(_param().layers()[i]));
+                LayerSharedPtr layer(Create((*_param)().layers()[i]));
                 if (layer)
                     _layers.push_back(layer);
             }
 
-            std::ifstream ifs(weight.c_str(), std::ifstream::binary);
-            if (!ifs.is_open())
+            if (map)
             {
-                std::cout << "Can't open weight file '" << weight << "' !" << std::endl;
-                return false;
+                _map.reset(new MemoryMap());
+                if (!_map->Open(weight))
+                {
+                    std::cout << "Can't map weight file '" << weight << "' !" << std::endl;
+                    return false;
+                }
+                const char * data = _map->Data();
+                size_t size = _map->Size();
+                for (size_t i = 0; i < _layers.size(); ++i)
+                {
+                    if (!_layers[i]->Load(data, size, _layers, true))
+                    {
+                        std::cout << "Can't load weight from file '" << weight << "' !" << std::endl;
+                        return false;
+                    }
+                }
             }
-            for (size_t i = 0; i < _layers.size(); ++i)
+            else
             {
-                if (!_layers[i]->Load(ifs, _layers))
+                std::ifstream ifs(weight.c_str(), std::ifstream::binary);
+                if (!ifs.is_open())
                 {
-                    std::cout << "Can't load weight from file '" << weight << "' !" << std::endl;
-                    ifs.close();
+                    std::cout << "Can't open weight file '" << weight << "' !" << std::endl;
                     return false;
                 }
+                for (size_t i = 0; i < _layers.size(); ++i)
+                {
+                    if (!_layers[i]->Load(ifs, _layers))
+                    {
+                        std::cout << "Can't load weight from file '" << weight << "' !" << std::endl;
+                        ifs.close();
+                        return false;
+                    }
+                }
+                ifs.close();
             }
-            ifs.close();
 
             return Init();
         }
 
         bool Load(const char * modelData, size_t modelSize, const char * weightData, size_t weightSize)
         {
-            if (!_param.Load(modelData, modelSize))
+            _param.reset(new NetworkParamHolder());
+            _map.reset();
+            _shared = false;
+            if (!_param->Load(modelData, modelSize))
                 return false;
 
             _layers.clear();
-            for (size_t i = 0; i < _param().layers().size(); ++i)
+            for (size_t i = 0; i < (*_param)().layers().size(); ++i)
             {
-                LayerSharedPtr layer(Create(_param().layers()[i]));
+                LayerSharedPtr layer(Create((*_param)().layers()[i]));
                 if (layer)
                     _layers.push_back(layer);
             }
@@ -170,6 +256,154 @@ namespace Synet
             return Init();
         }
 
+        // Creates an execution context that shares the model description and layer weights of a loaded network.
+        // Limitation: with SYNET_SIMD_LIBRARY_ENABLE, float convolutions handled by Simd keep their repacked weights
+        // inside a per-context Simd object, so each context still owns a copy of those weights.
+        bool Share(const Network & network)
+        {
+            if (network.Empty())
+                return false;
+
+            _param = network._param;
+            _map = network._map;
+            _shared = true;
+
+            _layers.clear();
+            for (size_t i = 0; i < network._layers.size(); ++i)
+            {
+                const Layer & origin = *network._layers[i];
+                LayerSharedPtr layer(Create(origin.Param()));
+                if (!layer || !layer->Share(origin))
+                {
+                    std::cout << "Can't share weight of layer '" << origin.Param().name() << "' !" << std::endl;
+                    return false;
+                }
+                _layers.push_back(layer);
+            }
+
+            return Init();
+        }
+
+        // Loads a single-file model written by SaveBinary: binary parameters and 64-byte aligned raw weights, mapped zero-copy.
+        // It skips XML parsing and weight reading only. The stage graph, memory plan and packed (GEMM, Winograd, int8) weights
+        // are not stored in the file and are rebuilt by Init exactly as after Load.
+        bool LoadBinary(const String & path)
+        {
+            _param.reset(new NetworkParamHolder());
+            _map.reset(new MemoryMap());
+            _shared = false;
+            if (!_map->Open(path) || _map->Size() < sizeof(Detail::BinaryHeader))
+            {
+                std::cout << "Can't map binary model file '" << path << "' !" << std::endl;
+                return false;
+            }
+            const char * data = _map->Data();
+            Detail::BinaryHeader header;
+            memcpy(&header, data, sizeof(header));
+            if (!Detail::BinaryHeader(sizeof(T), NetworkParamHolder().Signature()).Compatible(header) ||
+                header.paramOffset + header.paramSize > _map->Size() || header.weightOffset + header.weightSize > _map->Size())
+            {
+                std::cout << "Binary model file '" << path << "' is incompatible or damaged !" << std::endl;
+                return false;
+            }
+            if (!_param->LoadBinary(data + header.paramOffset, (size_t)header.paramSize))
+            {
+                std::cout << "Can't load model from binary model file '" << path << "' !" << std::endl;
+                return false;
+            }
+
+            _layers.clear();
+            for (size_t i = 0; i < (*_param)().layers().size(); ++i)
+            {
+                LayerSharedPtr layer(Create((*_param)().layers()[i]));
+                if (layer)
+                    _layers.push_back(layer);
+            }
+
+            const char * weight = data + header.weightOffset;
+            size_t size = (size_t)header.weightSize;
+            for (size_t i = 0; i < _layers.size(); ++i)
+            {
+                if (!_layers[i]->Load(weight, size, _layers, true))
+                {
+                    std::cout << "Can't load weight from binary model file '" << path << "' !" << std::endl;
+                    return false;
+                }
+            }
+
+            return Init();
+        }
+
+        bool SaveBinary(const String & path) const
+        {
+            if (_empty)
+                return false;
+
+            std::stringstream model;
+            NetworkParamHolder param;
+            _param->SaveBinary(model);
+            if (!param.LoadBinary(model.str().data(), model.str().size()))
+                return false;
+
+            std::map<const void*, size_t> unique;
+            std::vector<const Tensor*> blobs;
+            size_t weightSize = 0;
+            for (size_t i = 0; i < _layers.size(); ++i)
+            {
+                const Layer & layer = *_layers[i];
+                LayerParam & layerParam = param().layers()[&layer.Param() - (*_param)().layers().data()];
+                for (size_t j = 0; j < layer.Weight().size(); ++j)
+                {
+                    const Tensor & tensor = layer.Weight()[j];
+                    WeightParam & weightParam = layerParam.weight()[j];
+                    if (tensor.Shape() != weightParam.dim())
+                    {
+                        std::cout << "Can't save binary model: weight of layer '" << layerParam.name() << "' was compacted !" << std::endl;
+                        return false;
+                    }
+                    const void * ptr = tensor.CpuData();
+                    if (unique.find(ptr) == unique.end())
+                    {
+                        unique[ptr] = weightSize;
+                        blobs.push_back(&tensor);
+                        weightSize = Detail::BinaryHeader::Align(weightSize + tensor.Size() * sizeof(T));
+                    }
+                    weightParam.offset() = unique[ptr];
+                    weightParam.size() = tensor.Size() * sizeof(T);
+                }
+            }
+            model.str(String());
+            param.SaveBinary(model);
+            String modelData = model.str();
+
+            Detail::BinaryHeader header(sizeof(T), NetworkParamHolder().Signature());
+            header.paramOffset = sizeof(header);
+            header.paramSize = modelData.size();
+            header.weightOffset = Detail::BinaryHeader::Align(header.paramOffset + header.paramSize);
+            header.weightSize = weightSize;
+
+            std::ofstream ofs(path.c_str(), std::ofstream::binary);
+            if (!ofs.is_open())
+            {
+                std::cout << "Can't create binary model file '" << path << "' !" << std::endl;
+                return false;
+            }
+            std::vector<char> zero(Detail::BinaryHeader::ALIGN, 0);
+            ofs.write((const char*)&header, sizeof(header));
+            ofs.write(modelData.data(), modelData.size());
+            ofs.write(zero.data(), header.weightOffset - header.paramOffset - header.paramSize);
+            for (size_t i = 0, offset = 0; i < blobs.size(); ++i)
+            {
+                size_t size = blobs[i]->Size() * sizeof(T);
+                ofs.write((const char*)blobs[i]->CpuData(), size);
+                ofs.write(zero.data(), Detail::BinaryHeader::Align(offset + size) - offset - size);
+                offset = Detail::BinaryHeader::Align(offset + size);
+            }
+            bool result = (bool)ofs;
+            ofs.close();
+            return result;
+        }
+
         TensorPtrs & Src() 
         { 
             return _src; 
@@ -214,6 +448,11 @@ namespace Synet
                         {
                             if (param.type() == LayerTypeInput)
                             {
+                                if ((*_param)().fixedShape() && (param.input().shape().empty() || srcShapes[i] != param.input().shape()[0].dim()))
+                                {
+                                    std::cout << "Input '" << srcNames[i] << "' can't be reshaped: the model has shape-dependent layers folded to constants!" << std::endl;
+                                    return false;
+                                }
                                 _input[j].dst[0]->Reshape(srcShapes[i], Type(0), param.input().shape()[0].format());
                                 _src.push_back(_input[j].dst[0]);
                             }
@@ -269,6 +508,9 @@ namespace Synet
                 }
             }
 
+            PlanMemory();
+            PlanExecutor();
+
             return true;
         }
 
@@ -283,6 +525,8 @@ namespace Synet
             Shape shape = param.input().shape()[0].dim();
             if (shape.size() != 4)
                 return false;
+            if ((*_param)().fixedShape() && shape[0] != batch)
+                return false;
             shape[0] = batch;
             if (format == TensorFormatNchw)
             {
@@ -308,14 +552,18 @@ namespace Synet
                 return false;
             _input[0].dst[0]->Reshape(shape, Type(0), format);
             ReshapeStages();
+            PlanMemory();
+            PlanExecutor();
             return true;
         }
 
         bool Resizable() const
         {
-            for (size_t i = 0; i < _param().layers().size(); ++i)
+            if ((*_param)().fixedShape())
+                return false;
+            for (size_t i = 0; i < (*_param)().layers().size(); ++i)
             {
-                const LayerParam & layer = _param().layers()[i];
+                const LayerParam & layer = (*_param)().layers()[i];
                 if (layer.type() == LayerTypeInnerProduct)
                     return false;
             }
@@ -365,9 +613,9 @@ namespace Synet
 
         bool GetMetaConst(const String & name, Tensor & value) const
         {
-            for (size_t i = 0; i < _param().layers().size(); ++i)
+            for (size_t i = 0; i < (*_param)().layers().size(); ++i)
             {
-                const LayerParam & layer = _param().layers()[i];
+                const LayerParam & layer = (*_param)().layers()[i];
                 if (layer.name() == name && layer.type() == LayerTypeMeta && layer.meta().type() == MetaTypeConst)
                 {
                     value.Import(layer.meta().alpha());
@@ -377,6 +625,14 @@ namespace Synet
             return false;
         }
 
+        // Intermediate tensors share the memory arena, so after Forward() they may be overwritten by later stages.
+        // Call SetKeepTensors(true) to keep every intermediate tensor valid for inspection.
+        const Tensor * GetTensor(const String & name) const
+        {
+            NameIdMap::const_iterator it = _tensorId.find(name);
+            return it == _tensorId.end() ? NULL : _tensors[it->second].get();
+        }
+
         TensorFormat Format() const
         {
             for (size_t i = 0; i < _input.size(); ++i)
@@ -389,23 +645,130 @@ namespace Synet
             return TensorFormatUnknown;
         }
 
+        size_t GetInterOpThreads() const
+        {
+            return _interOp;
+        }
+
+        void SetInterOpThreads(size_t number)
+        {
+            _interOp = std::max<size_t>(number, 1);
+            if (!_empty)
+                PlanExecutor();
+        }
+
+        bool GetKeepTensors() const
+        {
+            return _keepTensors;
+        }
+
+        void SetKeepTensors(bool keep)
+        {
+            _keepTensors = keep;
+            if (!_empty)
+            {
+                PlanMemory();
+                PlanExecutor();
+            }
+        }
+
+        bool GetTuning() const
+        {
+            return _tuning;
+        }
+
+        void SetTuning(bool enable, const String & cache = String())
+        {
+            _tuning = enable;
+            if (_tuning && cache.size())
+                _tuningCache.Load(cache);
+            if (_tuning && !_empty)
+            {
+                ReshapeStages();
+                PlanMemory();
+                PlanExecutor();
+            }
+        }
+
         void Forward()
         {
             //SYNET_PERF_FUNC();
+#ifdef SYNET_ALLOCATION_CHECK
+            _allocations.allocations = 0;
+            _allocations.frees = 0;
+            Detail::AllocationScope scope(&_allocations);
+#endif
             bool mode = GetFastMode();
             SetFastMode(true);
-            for (size_t i = 0; i < _stages.size(); ++i)
+            if (_bufs.size() > 1)
+                _executor.Run(_function);
+            else
             {
+                for (size_t i = 0; i < _stages.size(); ++i)
+                {
 #if 0
-                std::cout << _stages[i].layer->Param().name() << " : { ";
-                const Shape & shape = _stages[i].src[0]->Shape();
-                for (size_t j = 0; j < shape.size(); ++j)
-                    std::cout << shape[j] << " ";
-                std::cout << "}" << std::endl;
+                    std::cout << _stages[i].layer->Param().name() << " : { ";
+                    const Shape & shape = _stages[i].src[0]->Shape();
+                    for (size_t j = 0; j < shape.size(); ++j)
+                        std::cout << shape[j] << " ";
+                    std::cout << "}" << std::endl;
 #endif
-                _stages[i].layer->Forward(_stages[i].src, _stages[i].buf, _stages[i].dst);
+                    _stages[i].layer->Forward(_stages[i].src, _stages[i].buf, _stages[i].dst);
+                }
             }
             SetFastMode(mode);
+#ifdef SYNET_ALLOCATION_CHECK
+            size_t allocations = _allocations.allocations, frees = _allocations.frees;
+            if (_forwarded && (allocations || frees))
+                std::cout << "Network::Forward() makes " << allocations << " allocation(s) and " << frees << " free(s) after the first run!" << std::endl;
+            _forwarded = true;
+#endif
+        }
+
+        typedef std::function<bool(size_t index, const TensorPtrs & src)> CalibrationInput;
+
+        bool Calibrate(size_t count, const CalibrationInput & input, CalibrationType type = CalibrationMinMax, float percentile = 99.99f)
+        {
+            if (_empty || count == 0 || Is8i())
+            {
+                std::cout << "Can't calibrate network: it must be loaded in 32-bit float mode!" << std::endl;
+                return false;
+            }
+            NameIdMap writer;
+            for (size_t i = 0; i < _input.size(); ++i)
+                for (size_t j = 0; j < _input[i].layer->Param().dst().size(); ++j)
+                    writer[_input[i].layer->Param().dst()[j]] = 0;
+            for (size_t i = 0; i < _stages.size(); ++i)
+                for (size_t j = 0; j < _stages[i].layer->Param().dst().size(); ++j)
+                    writer[_stages[i].layer->Param().dst()[j]] = i + 1;
+            Calibration calibration(type, percentile);
+            bool mode = GetFastMode();
+            SetFastMode(true);
+            for (size_t pass = 0; pass < calibration.Passes(); ++pass)
+            {
+                if (pass)
+                    calibration.NextPass();
+                for (size_t index = 0; index < count; ++index)
+                {
+                    if (!input(index, _src))
+                    {
+                        std::cout << "Can't set calibration input " << index << " !" << std::endl;
+                        SetFastMode(mode);
+                        return false;
+                    }
+                    for (size_t i = 0; i < _input.size(); ++i)
+                        UpdateCalibration(calibration, _input[i], writer, 0);
+                    for (size_t i = 0; i < _stages.size(); ++i)
+                    {
+                        _stages[i].layer->Forward(_stages[i].src, _stages[i].buf, _stages[i].dst);
+                        UpdateCalibration(calibration, _stages[i], writer, i + 1);
+                    }
+                }
+            }
+            SetFastMode(mode);
+            calibration.Export((*_param)().statistics());
+            ConformStatistics((*_param)().statistics());
+            return true;
         }
 
         void DebugPrint(std::ostream & os, int flag, int first, int last, int precision)
@@ -462,56 +825,48 @@ namespace Synet
             }
         }
 
-        Regions GetRegions(size_t imageW, size_t imageH, Type threshold, Type overlap) const
+        void GetRegions(size_t imageW, size_t imageH, Type threshold, Type overlap, Regions & regions, RegionsBuffer & buffer, size_t topK = 0) const
         {
-            size_t netW = _src[0]->Axis(-1);
-            size_t netH = _src[0]->Axis(-2);
-            Regions regions;
+            buffer.candidats.clear();
             for (size_t i = 0; i < _dst.size(); ++i)
+                GetCandidats(i, -1, imageW, imageH, threshold, buffer);
+            Suppress(buffer, overlap, topK, regions);
+        }
+
+        void GetRegions(size_t imageW, size_t imageH, Type threshold, Type overlap, Regions & regions, size_t topK = 0) const
+        {
+            RegionsBuffer buffer;
+            GetRegions(imageW, imageH, threshold, overlap, regions, buffer, topK);
+        }
+
+        Regions GetRegions(size_t imageW, size_t imageH, Type threshold, Type overlap, size_t topK = 0) const
+        {
+            Regions regions;
+            GetRegions(imageW, imageH, threshold, overlap, regions, topK);
+            return regions;
+        }
+
+        std::vector<Regions> GetBatchRegions(size_t imageW, size_t imageH, Type threshold, Type overlap, size_t topK = 0) const
+        {
+            std::vector<Regions> regions(_src[0]->Axis(0));
+            RegionsBuffer buffer;
+            for (size_t b = 0; b < regions.size(); ++b)
             {
-                TensorPtrs dst(1, _dst[i]);
-                const Layer * layer = _back[i];
-                Regions candidats;
-                if (layer->Param().type() == Synet::LayerTypeYolo)
-                    ((YoloLayer<float>*)layer)->GetRegions(dst, netW, netH, threshold, candidats);
-                if (layer->Param().type() == Synet::LayerTypeRegion)
-                    ((RegionLayer<float>*)layer)->GetRegions(dst, threshold, candidats);
-                if (layer->Param().type() == Synet::LayerTypeDetectionOutput)
-                    ((DetectionOutputLayer<float>*)layer)->GetRegions(dst, threshold, candidats);
-                for (size_t j = 0; j < candidats.size(); ++j)
-                {
-                    Region & c = candidats[j];
-                    c.x *= imageW;
-                    c.w *= imageW;
-                    c.y *= imageH;
-                    c.h *= imageH;
-                    bool insert = true;
-                    for (size_t k = 0; k < regions.size(); ++k)
-                    {
-                        Region & r = regions[k];
-                        if (c.id == r.id && RelativeIntersection(c, r) >= overlap)
-                        {
-                            if (c.prob > r.prob)
-                               r = c;
-                            insert = false;
-                            break;
-                        }
-                    }
-                    if (insert)
-                        regions.push_back(c);
-                }
+                buffer.candidats.clear();
+                for (size_t i = 0; i < _dst.size(); ++i)
+                    GetCandidats(i, b, imageW, imageH, threshold, buffer);
+                Suppress(buffer, overlap, topK, regions[b]);
             }
-            std::sort(regions.begin(), regions.end(), [](const Region & a, const Region & b) {return a.prob > b.prob; });
             return regions;
         }
 
-        size_t MemoryUsage() const
+        size_t MemoryUsage(bool planned = true) const
         {
             std::set<const void*> unique;
             size_t memoryUsage = 0;
             for (size_t i = 0; i < _layers.size(); ++i)
             {
-                for (size_t j = 0; j < _layers[i]->Weight().size(); ++j)
+                for (size_t j = 0; j < _layers[i]->Weight().size() && !_shared; ++j)
                 {
                     if (_layers[i]->Weight()[j].Size() == 0)
                         continue;
@@ -535,13 +890,20 @@ namespace Synet
                     unique.insert(ptr);
                 }
             }
+            for (size_t i = 0; i < _scratch.size(); ++i)
+                memoryUsage += _scratch[i]->RawSize();
+            memoryUsage += planned ? _arena.size : _naive;
             return memoryUsage;
         }
 
+        // Releases source weights of layers which keep them in packed form. Convolutions keep their source weights
+        // while tuning is enabled or the weights are shared with another network, since both can switch a layer to
+        // another algorithm later. Otherwise a compacted convolution stays with its current algorithm.
         void CompactWeight()
         {
+            bool keepSource = _tuning || _param.use_count() > 1;
             for (size_t i = 0; i < _layers.size(); ++i)
-                _layers[i]->CompactWeight();
+                _layers[i]->CompactWeight(keepSource);
         }
 
     private:
@@ -567,8 +929,20 @@ namespace Synet
         };
         typedef std::vector<Stage> Stages;
 
-        bool _empty;
-        NetworkParamHolder _param;
+        struct Block
+        {
+            size_t size, first, last, offset, parent, shift;
+            bool fixed;
+            TensorPtrs tensors;
+        };
+        typedef std::vector<Block> Blocks;
+        typedef std::map<const void*, size_t> PtrIdMap;
+
+        typedef std::shared_ptr<NetworkParamHolder> NetworkParamPtr;
+
+        bool _empty, _shared;
+        NetworkParamPtr _param;
+        MemoryMapPtr _map;
         LayerSharedPtrs _layers;
         TensorSharedPtrs _tensors;
         StatSharedPtrs _stats;
@@ -578,10 +952,32 @@ namespace Synet
         LayerPtrs _back;
         NameIdMap _tensorId, _layerId, _statId;
         NameIdSetMap _srcIds, _dstIds;
+        Synet::Buffer<uint8_t> _arena;
+        size_t _naive;
+
+        size_t _interOp;
+        Executor _executor;
+        Executor::Function _function;
+        TensorSharedPtrs _scratch;
+        std::vector<TensorPtrs> _bufs;
+
+        bool _tuning;
+        TuningCache _tuningCache;
+
+        bool _keepTensors;
+
+#ifdef SYNET_ALLOCATION_CHECK
+        bool _forwarded;
+        Detail::AllocationCounter _allocations;
+#endif
 
         bool Init()
         {
             _tensors.clear();
+            _arena.Resize(0);
+            _naive = 0;
+            _scratch.clear();
+            _bufs.clear();
             _input.clear();
             _stages.clear();
             _stats.clear();
@@ -808,9 +1204,353 @@ namespace Synet
             for (size_t i = 0; i < _stages.size(); ++i)
             {
                 _stages[i].layer->Reshape(_stages[i].src, _stages[i].buf, _stages[i].dst);
+                if (_tuning)
+                    Tune(_stages[i]);
                 if (_stages[i].layer->_isBack)
                     _stages[i].dst[0]->SetName(_stages[i].layer->Param().name());
             }
+            if (_tuning)
+                _tuningCache.Save();
+#ifdef SYNET_ALLOCATION_CHECK
+            _forwarded = false;
+#endif
+        }
+
+        void Tune(const Stage & stage)
+        {
+            Layer & layer = *stage.layer;
+            Ints algorithms = layer.Algorithms();
+            if (algorithms.size() < 2)
+                return;
+            String key = TuningCache::CpuId() + "\t" + ValueToString(layer.Param().type()) + "\t" + layer.TuningKey();
+            int best = algorithms[0];
+            if (!_tuningCache.Find(key, best) || std::find(algorithms.begin(), algorithms.end(), best) == algorithms.end())
+            {
+                double min = DBL_MAX;
+                for (size_t i = 0; i < algorithms.size(); ++i)
+                {
+                    layer.SetAlgorithm(algorithms[i]);
+                    layer.Reshape(stage.src, stage.buf, stage.dst);
+                    double time = TuneTime(stage);
+                    if (time < min)
+                    {
+                        min = time;
+                        best = algorithms[i];
+                    }
+                }
+                _tuningCache.Insert(key, best);
+            }
+            layer.SetAlgorithm(best);
+            layer.Reshape(stage.src, stage.buf, stage.dst);
+        }
+
+        double TuneTime(const Stage & stage)
+        {
+            stage.layer->Forward(stage.src, stage.buf, stage.dst);
+            double min = DBL_MAX, total = 0;
+            for (size_t i = 0; i < 16 && (i < 3 || total < 0.01); ++i)
+            {
+                double start = TuningCache::Time();
+                stage.layer->Forward(stage.src, stage.buf, stage.dst);
+                double time = TuningCache::Time() - start;
+                min = std::min(min, time);
+                total += time;
+            }
+            return min;
+        }
+
+        bool Resident(const Layer & layer) const
+        {
+            const LayerType type = layer.Param().type();
+            return type == LayerTypeConst || type == LayerTypeMeta || type == LayerTypePriorBox || type == LayerTypePriorBoxClustered;
+        }
+
+        bool Planned(const Tensor & tensor) const
+        {
+            const uint8_t * data = (const uint8_t*)tensor.RawData();
+            return data >= _arena.data && data < _arena.data + _arena.size;
+        }
+
+        void AddToBlocks(const TensorPtrs & tensors, size_t stage, bool fixed, Blocks & blocks, PtrIdMap & blockId)
+        {
+            for (size_t i = 0; i < tensors.size(); ++i)
+            {
+                Tensor * tensor = tensors[i];
+                const void * data = tensor->RawData();
+                if (data == NULL)
+                    continue;
+                PtrIdMap::const_iterator it = blockId.find(data);
+                if (it == blockId.end())
+                {
+                    Block block;
+                    block.size = tensor->RawSize();
+                    block.first = stage;
+                    block.last = stage;
+                    block.offset = 0;
+                    block.parent = (size_t)-1;
+                    block.shift = 0;
+                    block.fixed = fixed || !(tensor->Owner() || Planned(*tensor));
+                    block.tensors.push_back(tensor);
+                    blockId[data] = blocks.size();
+                    blocks.push_back(block);
+                }
+                else
+                {
+                    Block & block = blocks[it->second];
+                    block.size = std::max(block.size, tensor->RawSize());
+                    block.first = std::min(block.first, stage);
+                    block.last = std::max(block.last, stage);
+                    block.fixed = block.fixed || fixed || !(tensor->Owner() || Planned(*tensor));
+                    if (std::find(block.tensors.begin(), block.tensors.end(), tensor) == block.tensors.end())
+                        block.tensors.push_back(tensor);
+                }
+            }
+        }
+
+        void FixBlocks(const TensorPtrs & tensors, Blocks & blocks, const PtrIdMap & blockId)
+        {
+            for (size_t i = 0; i < tensors.size(); ++i)
+            {
+                PtrIdMap::const_iterator it = blockId.find(tensors[i]->RawData());
+                if (it != blockId.end())
+                    blocks[it->second].fixed = true;
+            }
+        }
+
+        static size_t DataSize(const Tensor & tensor)
+        {
+            return tensor.Size() * Detail::TensorTypeSize(tensor.GetType());
+        }
+
+        bool WrittenAfter(const void * data, size_t stage) const
+        {
+            for (size_t s = stage + 1; s < _stages.size(); ++s)
+            {
+                for (size_t i = 0; i < _stages[s].dst.size(); ++i)
+                    if (_stages[s].dst[i]->RawData() == data)
+                        return true;
+            }
+            return false;
+        }
+
+        static uint8_t * BlockData(const Blocks & blocks, size_t index)
+        {
+            const Block & block = blocks[index];
+            if (block.parent == (size_t)-1)
+                return (uint8_t*)block.tensors[0]->RawData();
+            return BlockData(blocks, block.parent) + block.shift;
+        }
+
+        // Concat inputs are placed back to back inside the output, so a child offset is only a multiple of the element size, not of 64.
+        // This is safe: the concat output is aligned, all Synet kernels use unaligned loads and stores (loadu/storeu),
+        // and Simd Library checks pointer alignment at run time before it takes an aligned code path.
+        void PlanConcats(Blocks & blocks, const PtrIdMap & blockId)
+        {
+            for (size_t s = 0; s < _stages.size(); ++s)
+            {
+                const Stage & stage = _stages[s];
+                const LayerParam & param = stage.layer->Param();
+                if (param.type() != LayerTypeConcat || stage.src.size() < 2 || Resident(*stage.layer))
+                    continue;
+                const Tensor & dst = *stage.dst[0];
+                PtrIdMap::const_iterator d = blockId.find(dst.RawData());
+                if (d == blockId.end() || dst.Size(0, param.concat().axis()) != 1)
+                    continue;
+                bool written = WrittenAfter(dst.RawData(), s), merge = true;
+                std::vector<size_t> ids;
+                size_t total = 0;
+                for (size_t i = 0; i < stage.src.size() && merge; ++i)
+                {
+                    const Tensor & src = *stage.src[i];
+                    PtrIdMap::const_iterator it = blockId.find(src.RawData());
+                    if (it == blockId.end() || it->second == d->second || std::find(ids.begin(), ids.end(), it->second) != ids.end())
+                        merge = false;
+                    else
+                    {
+                        const Block & block = blocks[it->second];
+                        if (block.fixed || block.parent != (size_t)-1 || block.size != DataSize(src) || src.GetType() != dst.GetType() ||
+                            (written && block.last > s) || WrittenAfter(src.RawData(), s))
+                            merge = false;
+                        ids.push_back(it->second);
+                        total += DataSize(src);
+                    }
+                }
+                if (!merge || total != DataSize(dst))
+                    continue;
+                Block & parent = blocks[d->second];
+                for (size_t i = 0, shift = 0; i < ids.size(); ++i)
+                {
+                    Block & block = blocks[ids[i]];
+                    block.parent = d->second;
+                    block.shift = shift;
+                    shift += block.size;
+                    parent.first = std::min(parent.first, block.first);
+                    parent.last = std::max(parent.last, block.last);
+                }
+            }
+        }
+
+        void PlanMemory()
+        {
+            const size_t align = 64;
+            Blocks blocks;
+            PtrIdMap blockId;
+            for (size_t s = 0; s < _stages.size(); ++s)
+            {
+                AddToBlocks(_stages[s].src, s, false, blocks, blockId);
+                AddToBlocks(_stages[s].dst, s, Resident(*_stages[s].layer), blocks, blockId);
+            }
+            FixBlocks(_src, blocks, blockId);
+            FixBlocks(_dst, blocks, blockId);
+            PlanConcats(blocks, blockId);
+
+            std::vector<size_t> order;
+            for (size_t i = 0; i < blocks.size(); ++i)
+            {
+                if (blocks[i].parent != (size_t)-1)
+                    continue;
+                blocks[i].size = (blocks[i].size + align - 1) / align * align;
+                if (_keepTensors)
+                    blocks[i].first = 0, blocks[i].last = _stages.size();
+                if (!blocks[i].fixed && blocks[i].size)
+                    order.push_back(i);
+            }
+            std::stable_sort(order.begin(), order.end(), [&blocks](size_t a, size_t b) { return blocks[a].size > blocks[b].size; });
+
+            size_t total = 0, naive = 0;
+            std::vector<size_t> placed;
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                Block & block = blocks[order[i]];
+                std::vector<size_t> alive;
+                for (size_t j = 0; j < placed.size(); ++j)
+                {
+                    const Block & other = blocks[placed[j]];
+                    if (other.first <= block.last && block.first <= other.last)
+                        alive.push_back(placed[j]);
+                }
+                std::sort(alive.begin(), alive.end(), [&blocks](size_t a, size_t b) { return blocks[a].offset < blocks[b].offset; });
+                size_t offset = 0, best = (size_t)-1, bestGap = (size_t)-1;
+                for (size_t j = 0; j < alive.size(); ++j)
+                {
+                    const Block & other = blocks[alive[j]];
+                    if (other.offset >= offset)
+                    {
+                        size_t gap = other.offset - offset;
+                        if (gap >= block.size && gap < bestGap)
+                        {
+                            best = offset;
+                            bestGap = gap;
+                        }
+                    }
+                    offset = std::max(offset, other.offset + other.size);
+                }
+                block.offset = best == (size_t)-1 ? offset : best;
+                total = std::max(total, block.offset + block.size);
+                naive += block.size;
+                placed.push_back(order[i]);
+            }
+
+            Synet::Buffer<uint8_t> arena(total);
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                const Block & block = blocks[order[i]];
+                for (size_t j = 0; j < block.tensors.size(); ++j)
+                    block.tensors[j]->Relocate(arena.data + block.offset);
+            }
+            for (size_t i = 0; i < blocks.size(); ++i)
+            {
+                if (blocks[i].parent == (size_t)-1)
+                    continue;
+                uint8_t * data = BlockData(blocks, i);
+                for (size_t j = 0; j < blocks[i].tensors.size(); ++j)
+                    blocks[i].tensors[j]->Relocate(data);
+            }
+            _arena.Swap(arena);
+            _naive = naive;
+        }
+
+        static bool Overlap(const TensorPtrs & a, const TensorPtrs & b)
+        {
+            for (size_t i = 0; i < a.size(); ++i)
+            {
+                const uint8_t * aData = (const uint8_t*)a[i]->RawData();
+                size_t aSize = a[i]->RawSize();
+                for (size_t j = 0; j < b.size() && aSize; ++j)
+                {
+                    const uint8_t * bData = (const uint8_t*)b[j]->RawData();
+                    size_t bSize = b[j]->RawSize();
+                    if (bSize && aData < bData + bSize && bData < aData + aSize)
+                        return true;
+                }
+            }
+            return false;
+        }
+
+        void PlanExecutor()
+        {
+            _scratch.clear();
+            _bufs.clear();
+            if (_interOp < 2 || _stages.size() < 2)
+            {
+                _executor.Init(1, Executor::Graph());
+                return;
+            }
+
+            Executor::Graph depends(_stages.size());
+            for (size_t j = 0; j < _stages.size(); ++j)
+            {
+                IdSet ids;
+                const LayerParam & param = _stages[j].layer->Param();
+                for (size_t k = 0; k < param.src().size(); ++k)
+                {
+                    NameIdSetMap::const_iterator producers = _dstIds.find(param.src()[k]);
+                    if (producers == _dstIds.end())
+                        continue;
+                    for (IdSet::const_iterator it = producers->second.begin(); it != producers->second.end() && *it < j; ++it)
+                        ids.insert(*it);
+                }
+                for (size_t i = 0; i < j; ++i)
+                {
+                    const Stage & prev = _stages[i], & curr = _stages[j];
+                    if (Overlap(prev.dst, curr.src) || Overlap(prev.dst, curr.dst) || Overlap(prev.src, curr.dst))
+                        ids.insert(i);
+                }
+                depends[j].assign(ids.begin(), ids.end());
+            }
+
+            const TensorPtrs & buf = _stages[0].buf;
+            _bufs.resize(_interOp, buf);
+            for (size_t w = 1; w < _bufs.size(); ++w)
+            {
+                for (size_t i = 0; i < buf.size(); ++i)
+                {
+                    TensorSharedPtr tensor(new Tensor());
+                    TensorType type = buf[i]->GetType();
+                    tensor->SetType(type);
+                    Shape shape(1, buf[i]->RawSize() / Detail::TensorTypeSize(type));
+                    if (shape[0])
+                    {
+                        switch (type)
+                        {
+                        case TensorType32f: tensor->As32f().Extend(shape); break;
+                        case TensorType32i: tensor->As32i().Extend(shape); break;
+                        case TensorType8i: tensor->As8i().Extend(shape); break;
+                        case TensorType8u: tensor->As8u().Extend(shape); break;
+                        default: assert(0);
+                        }
+                    }
+                    _scratch.push_back(tensor);
+                    _bufs[w][i] = tensor.get();
+                }
+            }
+
+            _executor.Init(_interOp, depends);
+            _function = [this](size_t stage, size_t worker)
+            {
+                SetFastMode(true);
+                _stages[stage].layer->Forward(_stages[stage].src, _bufs[worker], _stages[stage].dst);
+            };
         }
 
         void SetBuffers(TensorPtrs & buf)
@@ -830,9 +1570,9 @@ namespace Synet
         void SetStats()
         {
             _stats.clear();
-            for (size_t i = 0; i < _param().statistics().size(); ++i)
+            for (size_t i = 0; i < (*_param)().statistics().size(); ++i)
             {
-                const StatisticParam & src = _param().statistics()[i];
+                const StatisticParam & src = (*_param)().statistics()[i];
                 StatSharedPtr stat(new Stat(src));
                 _statId[src.name()] = _stats.size();
                 _stats.push_back(stat);
@@ -841,21 +1581,65 @@ namespace Synet
 
         bool InsertDst(const String & name)
         {
-            if (_param().dst().empty())
+            if ((*_param)().dst().empty())
                 return true;
-            for (size_t i = 0; i < _param().dst().size(); ++i)
+            for (size_t i = 0; i < (*_param)().dst().size(); ++i)
             {
-                if (_param().dst()[i] == name)
+                if ((*_param)().dst()[i] == name)
                     return true;
             }
             return false;
         }
 
+        void UpdateCalibration(Calibration & calibration, const Stage & stage, const NameIdMap & writer, size_t index)
+        {
+            const LayerParam & param = stage.layer->Param();
+            for (size_t j = 0; j < param.dst().size() && j < stage.dst.size(); ++j)
+            {
+                const String & name = param.dst()[j];
+                if (writer.find(name)->second == index && stage.dst[j]->GetType() == TensorType32f)
+                    calibration.Update(name, stage.dst[j]->As32f());
+            }
+        }
+
+        void ConformStatistics(std::vector<StatisticParam> & statistics)
+        {
+            NameIdMap index;
+            for (size_t i = 0; i < statistics.size(); ++i)
+                index[statistics[i].name()] = i;
+            for (size_t s = 0; s < _stages.size(); ++s)
+            {
+                const LayerParam & param = _stages[s].layer->Param();
+                if (!(param.type() == LayerTypePooling || param.type() == LayerTypeConcat || 
+                    (param.type() == LayerTypeRelu && param.relu().negativeSlope() == 0.0f)))
+                    continue;
+                if (param.dst().empty() || index.find(param.dst()[0]) == index.end())
+                    continue;
+                StatisticParam & dst = statistics[index[param.dst()[0]]];
+                for (size_t i = 0, o = 0; i < param.src().size(); ++i)
+                {
+                    if (index.find(param.src()[i]) == index.end())
+                        break;
+                    const StatisticParam & src = statistics[index[param.src()[i]]];
+                    if (src.min().empty())
+                        break;
+                    float min = *std::min_element(src.min().begin(), src.min().end());
+                    float max = *std::max_element(src.max().begin(), src.max().end());
+                    size_t end = param.type() == LayerTypeConcat ? o + src.min().size() : dst.min().size();
+                    for (; o < end && o < dst.min().size(); ++o)
+                    {
+                        dst.min()[o] = std::min(std::max(dst.min()[o], min), max);
+                        dst.max()[o] = std::max(std::min(dst.max()[o], max), min);
+                    }
+                }
+            }
+        }
+
         bool Dynamic()
         {
-            for (size_t i = 0; i < _param().layers().size(); ++i)
+            for (size_t i = 0; i < (*_param)().layers().size(); ++i)
             {
-                const LayerParam & layer = _param().layers()[i];
+                const LayerParam & layer = (*_param)().layers()[i];
                 if (layer.type() == LayerTypeMeta && layer.meta().type() == MetaTypeInput)
                     return true;
                 if (layer.type() == LayerTypeInput)
@@ -937,35 +1721,77 @@ namespace Synet
             }
         }
 
-        static SYNET_INLINE Type Overlap(Type x1, Type w1, Type x2, Type w2)
-        {
-            Type l1 = x1 - w1 / 2;
-            Type l2 = x2 - w2 / 2;
-            Type left = l1 > l2 ? l1 : l2;
-            Type r1 = x1 + w1 / 2;
-            Type r2 = x2 + w2 / 2;
-            Type right = r1 < r2 ? r1 : r2;
-            return right - left;
-        }
-
-        static SYNET_INLINE Type Intersection(const Region & a, const Region & b)
+        void GetCandidats(size_t index, ptrdiff_t image, size_t imageW, size_t imageH, Type threshold, RegionsBuffer & buffer) const
         {
-            Type w = Overlap(a.x, a.w, b.x, b.w);
-            Type h = Overlap(a.y, a.h, b.y, b.h);
-            return (w < 0 || h < 0) ? 0 : w*h;
+            size_t netW = _src[0]->Axis(-1);
+            size_t netH = _src[0]->Axis(-2);
+            TensorPtrs & dst = buffer.dst;
+            dst.assign(1, _dst[index]);
+            const Layer * layer = _back[index];
+            Regions & regions = buffer.detected;
+            if (layer->Param().type() == Synet::LayerTypeYolo)
+                ((YoloLayer<float>*)layer)->GetRegions(dst, netW, netH, threshold, regions, std::max<ptrdiff_t>(image, 0));
+            if (layer->Param().type() == Synet::LayerTypeRegion)
+                ((RegionLayer<float>*)layer)->GetRegions(dst, threshold, regions, std::max<ptrdiff_t>(image, 0));
+            if (layer->Param().type() == Synet::LayerTypeDetectionOutput)
+                ((DetectionOutputLayer<float>*)layer)->GetRegions(dst, threshold, regions, image);
+            for (size_t i = 0; i < regions.size(); ++i)
+            {
+                Region & r = regions[i];
+                r.x *= imageW;
+                r.w *= imageW;
+                r.y *= imageH;
+                r.h *= imageH;
+                buffer.candidats.push_back(r);
+            }
         }
 
-        static SYNET_INLINE Type Union(const Region & a, const Region & b)
+        static void Suppress(RegionsBuffer & buffer, Type overlap, size_t topK, Regions & regions)
         {
-            Type i = Intersection(a, b);
-            return a.w*a.h + b.w*b.h - i;
+            Regions & candidats = buffer.candidats;
+            std::sort(candidats.begin(), candidats.end(), [](const Region & a, const Region & b) 
+            { 
+                return a.id < b.id || (a.id == b.id && a.prob > b.prob); 
+            });
+            regions.clear();
+            std::vector<Type> & left = buffer.left, & top = buffer.top, & right = buffer.right, & bottom = buffer.bottom, & area = buffer.area;
+            for (size_t begin = 0, end = 0; begin < candidats.size(); begin = end)
+            {
+                for (end = begin; end < candidats.size() && candidats[end].id == candidats[begin].id; ++end);
+                left.clear(), top.clear(), right.clear(), bottom.clear(), area.clear();
+                for (size_t i = begin; i < end && (topK == 0 || area.size() < topK); ++i)
+                {
+                    const Region & c = candidats[i];
+                    Type l = c.x - c.w / 2, t = c.y - c.h / 2, r = c.x + c.w / 2, b = c.y + c.h / 2, a = c.w * c.h;
+                    bool insert = true;
+                    for (size_t k = 0; k < area.size() && insert; ++k)
+                    {
+                        if (area[k] * overlap > a || a * overlap > area[k])
+                            continue;
+                        Type w = std::min(r, right[k]) - std::max(l, left[k]);
+                        Type h = std::min(b, bottom[k]) - std::max(t, top[k]);
+                        Type i = (w < 0 || h < 0) ? 0 : w * h;
+                        insert = !(i / (a + area[k] - i) >= overlap);
+                    }
+                    if (insert)
+                    {
+                        left.push_back(l);
+                        top.push_back(t);
+                        right.push_back(r);
+                        bottom.push_back(b);
+                        area.push_back(a);
+                        regions.push_back(c);
+                    }
+                }
+            }
+            std::sort(regions.begin(), regions.end(), [](const Region & a, const Region & b) 
+            {
+                return a.prob > b.prob || (a.prob == b.prob && a.id < b.id); 
+            });
+            if (topK && regions.size() > topK)
+                regions.resize(topK);
         }
 
-        static SYNET_INLINE Type RelativeIntersection(const Region & a, const Region & b)
-        {
-            return Intersection(a, b) / Union(a, b);
-        }
-        
         friend class TensorflowToSynet;
     };
 }
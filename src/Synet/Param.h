@@ -118,6 +118,25 @@ namespace Synet
             return result;
         }
 
+        bool SaveBinary(std::ostream & os) const
+        {
+            this->Write(os);
+            return (bool)os;
+        }
+
+        bool LoadBinary(const char * data, size_t size)
+        {
+            const char * end = data + size;
+            return this->Read(data, end) && data == end;
+        }
+
+        uint64_t Signature()
+        {
+            uint64_t hash = 0xcbf29ce484222325;
+            this->Signature(hash);
+            return hash;
+        }
+
     protected:
         enum Mode
         {
@@ -142,6 +161,9 @@ namespace Synet
         virtual String ToString() const { return ""; }
         virtual void ToValue(const String & string) {}
         virtual void Resize(size_t size) {}
+        virtual void ToBinary(std::ostream & os) const {}
+        virtual bool FromBinary(const char * & data, const char * end) { return true; }
+        virtual String TypeName() const { return ""; }
         SYNET_INLINE String ItemName() const { return "item"; }
 
         template<typename> friend struct Param;
@@ -240,6 +262,92 @@ namespace Synet
             }
             xmlParent->AppendNode(xmlCurrent);
         }
+
+        void Write(std::ostream & os) const
+        {
+            switch (_mode)
+            {
+            case Value:
+                this->ToBinary(os);
+                break;
+            case Struct:
+                for (const Unknown * paramChild = this->StructBegin(); paramChild < this->StructEnd(); paramChild = this->StructNext(paramChild))
+                    paramChild->Write(os);
+                break;
+            case Vector:
+            {
+                uint64_t size = 0;
+                for (const Unknown * paramItem = this->VectorBegin(); paramItem < this->VectorEnd(); paramItem = this->VectorNext(paramItem))
+                    size++;
+                os.write((const char*)&size, sizeof(size));
+                for (const Unknown * paramItem = this->VectorBegin(); paramItem < this->VectorEnd(); paramItem = this->VectorNext(paramItem))
+                {
+                    const Unknown * paramChildEnd = this->VectorNext(paramItem);
+                    for (const Unknown * paramChild = paramItem; paramChild < paramChildEnd; paramChild = this->StructNext(paramChild))
+                        paramChild->Write(os);
+                }
+                break;
+            }
+            }
+        }
+
+        bool Read(const char * & data, const char * end)
+        {
+            switch (_mode)
+            {
+            case Value:
+                return this->FromBinary(data, end);
+            case Struct:
+                for (Unknown * paramChild = this->StructBegin(); paramChild < this->StructEnd(); paramChild = this->StructNext(paramChild))
+                {
+                    if (!paramChild->Read(data, end))
+                        return false;
+                }
+                return true;
+            case Vector:
+            {
+                uint64_t size;
+                if (data + sizeof(size) > end)
+                    return false;
+                memcpy(&size, data, sizeof(size));
+                data += sizeof(size);
+                this->Resize((size_t)size);
+                for (Unknown * paramItem = this->VectorBegin(); paramItem < this->VectorEnd(); paramItem = this->VectorNext(paramItem))
+                {
+                    const Unknown * paramChildEnd = this->VectorNext(paramItem);
+                    for (Unknown * paramChild = paramItem; paramChild < paramChildEnd; paramChild = this->StructNext(paramChild))
+                    {
+                        if (!paramChild->Read(data, end))
+                            return false;
+                    }
+                }
+                return true;
+            }
+            }
+            return false;
+        }
+
+        void Signature(uint64_t & hash)
+        {
+            String name = _name + ":" + String(1, char('0' + _mode)) + ":" + this->TypeName() + ";";
+            for (size_t i = 0; i < name.size(); ++i)
+                hash = (hash ^ (uint8_t)name[i]) * 0x100000001b3;
+            switch (_mode)
+            {
+            case Value:
+                break;
+            case Struct:
+                for (Unknown * paramChild = this->StructBegin(); paramChild < this->StructEnd(); paramChild = this->StructNext(paramChild))
+                    paramChild->Signature(hash);
+                break;
+            case Vector:
+                this->Resize(1);
+                for (Unknown * paramChild = this->VectorBegin(); paramChild < this->VectorEnd(); paramChild = this->StructNext(paramChild))
+                    paramChild->Signature(hash);
+                this->Resize(0);
+                break;
+            }
+        }
     };
 
     template<class T> SYNET_INLINE  String ValueToString(const T & value)
@@ -270,6 +378,57 @@ namespace Synet
         return ss.str();
     }
 
+    template<class T> SYNET_INLINE void ValueToBinary(std::ostream & os, const T & value)
+    {
+        os.write((const char*)&value, sizeof(T));
+    }
+
+    SYNET_INLINE void ValueToBinary(std::ostream & os, const String & value)
+    {
+        uint64_t size = value.size();
+        os.write((const char*)&size, sizeof(size));
+        os.write(value.data(), value.size());
+    }
+
+    template<class T> SYNET_INLINE void ValueToBinary(std::ostream & os, const std::vector<T> & values)
+    {
+        uint64_t size = values.size();
+        os.write((const char*)&size, sizeof(size));
+        for (size_t i = 0; i < values.size(); ++i)
+            ValueToBinary(os, values[i]);
+    }
+
+    template<class T> SYNET_INLINE bool BinaryToValue(const char * & data, const char * end, T & value)
+    {
+        if (data + sizeof(T) > end)
+            return false;
+        memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return true;
+    }
+
+    SYNET_INLINE bool BinaryToValue(const char * & data, const char * end, String & value)
+    {
+        uint64_t size;
+        if (!BinaryToValue(data, end, size) || data + size > end)
+            return false;
+        value.assign(data, (size_t)size);
+        data += size;
+        return true;
+    }
+
+    template<class T> SYNET_INLINE bool BinaryToValue(const char * & data, const char * end, std::vector<T> & values)
+    {
+        uint64_t size;
+        if (!BinaryToValue(data, end, size) || size > uint64_t(end - data))
+            return false;
+        values.resize((size_t)size);
+        for (size_t i = 0; i < values.size(); ++i)
+            if (!BinaryToValue(data, end, values[i]))
+                return false;
+        return true;
+    }
+
     template<class T> SYNET_INLINE  void StringToValue(const String & string, T & value)
     {
         std::stringstream ss(string);
@@ -358,6 +517,9 @@ virtual Synet::String ToString() const { using namespace Synet; return ValueToSt
 virtual void ToValue(const Synet::String & string) { using namespace Synet; StringToValue(string, this->_value); } \
 virtual bool Changed() const { return this->Default() != this->_value; } \
 virtual void Clone(const Param_##name & other) { this->_value = other._value; } \
+virtual void ToBinary(std::ostream & os) const { using namespace Synet; ValueToBinary(os, this->_value); } \
+virtual bool FromBinary(const char * & data, const char * end) { using namespace Synet; return BinaryToValue(data, end, this->_value); } \
+virtual Synet::String TypeName() const { return #type; } \
 } name;
 
 #define SYNET_PARAM_STRUCT(type, name) \
@@ -570,6 +570,7 @@ namespace Synet
         SYNET_PARAM_VALUE(float, truthThresh, 1.0f);
         SYNET_PARAM_VALUE(Index, mask, Index());
         SYNET_PARAM_VALUE(Floats, anchors, Floats());
+        SYNET_PARAM_VALUE(bool, fused, false);
     };
 
     struct LayerParam
@@ -642,6 +643,7 @@ namespace Synet
         SYNET_PARAM_VALUE(int32_t, version, 0);
         SYNET_PARAM_VALUE(String, name, String());
         SYNET_PARAM_VALUE(Strings, dst, Strings());
+        SYNET_PARAM_VALUE(bool, fixedShape, false);
         SYNET_PARAM_VECTOR(LayerParam, layers);
         SYNET_PARAM_VECTOR(StatisticParam, statistics);
     };
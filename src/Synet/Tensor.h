@@ -29,6 +29,7 @@
 #include "Synet/Buffer.h"
 #include "Synet/Utils/Math.h"
 #include "Synet/Utils/DebugPrint.h"
+#include "Synet/Utils/Permute.h"
 
 namespace Synet
 {
@@ -44,6 +45,18 @@ namespace Synet
         template <> SYNET_INLINE TensorType GetTensorType<int32_t>() { return TensorType32i; }
         template <> SYNET_INLINE TensorType GetTensorType<int8_t>() { return TensorType8i; }
         template <> SYNET_INLINE TensorType GetTensorType<uint8_t>() { return TensorType8u; }
+
+        SYNET_INLINE size_t TensorTypeSize(TensorType type)
+        {
+            switch (type)
+            {
+            case TensorType32f: return 4;
+            case TensorType32i: return 4;
+            case TensorType8i: return 1;
+            case TensorType8u: return 1;
+            default: return 0;
+            }
+        }
     }
 
     template<class T> class Tensor
@@ -404,7 +417,7 @@ namespace Synet
             }
         }
 
-        SYNET_INLINE void Export(TensorParam & param)
+        SYNET_INLINE void Export(TensorParam & param) const
         {
             param.type() = _type;
             param.shape() = _shape;
@@ -439,6 +452,26 @@ namespace Synet
             _buffer->Capture();
         }
 
+        SYNET_INLINE bool Owner() const
+        {
+            return _buffer->Owner();
+        }
+
+        SYNET_INLINE const void * RawData() const
+        {
+            return _buffer->data;
+        }
+
+        SYNET_INLINE size_t RawSize() const
+        {
+            return _buffer->size * Detail::TensorTypeSize(_type);
+        }
+
+        SYNET_INLINE void Relocate(void * data)
+        {
+            _buffer->Share((const Type*)data, _buffer->size);
+        }
+
         void DebugPrint(std::ostream & os, const String & name, bool weight, size_t first, size_t last, size_t precision) const
         {
             switch (_type)
@@ -469,11 +502,7 @@ namespace Synet
                 if (weight)
                 {
                     Tensor<U> trans({ shape[3], shape[2], shape[0], shape[1] }, 0, TensorFormatNchw);
-                    for (size_t y = 0; y < shape[0]; ++y)
-                        for (size_t x = 0; x < shape[1]; ++x)
-                            for (size_t i = 0; i < shape[2]; ++i)
-                                for (size_t o = 0; o < shape[3]; ++o)
-                                    trans.CpuData({ o, i, y, x })[0] = tensor.CpuData({ y, x, i, o })[0];
+                    CpuPermute(tensor.CpuData(), shape, Synet::Shape({ 3, 2, 0, 1 }), trans.CpuData());
                     std::stringstream ss;
                     ss << name << " HWIO { ";
                     for (size_t i = 0; i < shape.size(); ++i)
@@ -484,11 +513,7 @@ namespace Synet
                 else
                 {
                     Tensor<U> trans({ shape[0], shape[3], shape[1], shape[2] }, 0, TensorFormatNchw);
-                    for (size_t n = 0; n < shape[0]; ++n)
-                        for (size_t c = 0; c < shape[3]; ++c)
-                            for (size_t y = 0; y < shape[1]; ++y)
-                                for (size_t x = 0; x < shape[2]; ++x)
-                                    trans.CpuData({ n, c, y, x })[0] = tensor.CpuData({ n, y, x, c })[0];
+                    CpuPermute(tensor.CpuData(), shape, Synet::Shape({ 0, 3, 1, 2 }), trans.CpuData());
                     std::stringstream ss;
                     ss << name << " NHWC { ";
                     for (size_t i = 0; i < shape.size(); ++i)
@@ -550,4 +575,4 @@ namespace Synet
     typedef Tensor<int32_t> Tensor32i;
     typedef Tensor<int8_t> Tensor8i;
     typedef Tensor<uint8_t> Tensor8u;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -33,6 +33,11 @@ namespace Synet
         return value >= T(0) ? value : alpha * (exp(value) - T(1));
     }
 
+    template <> SYNET_INLINE float CpuElu<float>(float value, float alpha)
+    {
+        return value >= 0.0f ? value : alpha * (ScalarExp(value) - 1.0f);
+    }
+
     template <typename T> void CpuElu(const T * src, size_t size, T alpha, T * dst)
     {
         for (size_t i = 0; i < size; ++i)
@@ -72,6 +77,11 @@ namespace Synet
         return T(1) / (T(1) + ::exp(-value));
     }   
 
+    template <> SYNET_INLINE float CpuSigmoid<float>(float value)
+    {
+        return ScalarSigmoid(value);
+    }
+
     template <typename T> void CpuSigmoid(const T * src, size_t size, T * dst)
     {
         for (size_t i = 0; i < size; ++i)
@@ -93,6 +103,29 @@ namespace Synet
 
     //-------------------------------------------------------------------------
 
+    template <typename T> SYNET_INLINE T CpuTanh(T value)
+    {
+        return ::tanh(value);
+    }
+
+    template <> SYNET_INLINE float CpuTanh<float>(float value)
+    {
+        return ScalarTanh(value);
+    }
+
+    template <typename T> void CpuTanh(const T * src, size_t size, T * dst)
+    {
+        for (size_t i = 0; i < size; ++i)
+            dst[i] = CpuTanh(src[i]);
+    }
+
+    template <> SYNET_INLINE void CpuTanh<float>(const float * src, size_t size, float * dst)
+    {
+        VectorTanh(src, size, dst);
+    }
+
+    //-------------------------------------------------------------------------
+
 #ifdef SYNET_SIMD_LIBRARY_ENABLE
     template <> SYNET_INLINE void CpuElu<float>(const float * src, size_t size, float alpha, float * dst)
     {
@@ -119,5 +152,20 @@ namespace Synet
     {
         ::SimdSynetSoftplus32f(src, size, &beta, &threshold, dst);
     }
+#else
+    template <> SYNET_INLINE void CpuElu<float>(const float * src, size_t size, float alpha, float * dst)
+    {
+        VectorElu(src, size, alpha, dst);
+    }
+
+    template <> SYNET_INLINE void CpuSigmoid<float>(const float * src, size_t size, float * dst)
+    {
+        VectorSigmoid(src, size, dst);
+    }
+
+    template<> SYNET_INLINE void CpuSoftplus<float>(const float * src, size_t size, float beta, float threshold, float * dst)
+    {
+        VectorSoftplus(src, size, beta, threshold, dst);
+    }
 #endif
 }
\ No newline at end of file
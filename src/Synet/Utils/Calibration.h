@@ -0,0 +1,272 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Common.h"
+#include "Synet/Params.h"
+#include "Synet/Tensor.h"
+
+namespace Synet
+{
+    enum CalibrationType
+    {
+        CalibrationMinMax = 0,
+        CalibrationPercentile,
+        CalibrationEntropy,
+    };
+
+    class Calibration
+    {
+    public:
+        Calibration(CalibrationType type = CalibrationMinMax, float percentile = 99.99f, size_t bins = 2048)
+            : _type(type)
+            , _percentile(percentile)
+            , _bins(bins)
+            , _pass(0)
+        {
+        }
+
+        size_t Passes() const
+        {
+            return _type == CalibrationMinMax ? 1 : 2;
+        }
+
+        void NextPass()
+        {
+            _pass++;
+            if (_pass == 1)
+            {
+                for (StatMap::iterator it = _stats.begin(); it != _stats.end(); ++it)
+                {
+                    Statistic & stat = it->second;
+                    stat.absMax = 0.0f;
+                    for (size_t c = 0; c < stat.min.size(); ++c)
+                        stat.absMax = std::max(stat.absMax, std::max(::fabs(stat.min[c]), ::fabs(stat.max[c])));
+                    stat.histogram.assign(_bins, 0);
+                }
+            }
+        }
+
+        void Update(const String & name, const Tensor<float> & tensor)
+        {
+            size_t channels, inner;
+            GetLayout(tensor, channels, inner);
+            if (channels == 0)
+                return;
+            Statistic & stat = _stats[name];
+            if (_pass == 0)
+            {
+                if (stat.min.empty())
+                {
+                    _names.push_back(name);
+                    stat.min.resize(channels, FLT_MAX);
+                    stat.max.resize(channels, -FLT_MAX);
+                }
+                if (stat.min.size() != channels)
+                    return;
+                UpdateMinMax(tensor, channels, inner, stat.min.data(), stat.max.data());
+            }
+            else if (stat.histogram.size() && stat.min.size() == channels)
+                UpdateHistogram(tensor, stat);
+        }
+
+        void Export(std::vector<StatisticParam> & statistics) const
+        {
+            statistics.clear();
+            for (size_t i = 0; i < _names.size(); ++i)
+            {
+                const Statistic & stat = _stats.find(_names[i])->second;
+                float threshold = Threshold(stat);
+                StatisticParam param;
+                param.name() = _names[i];
+                param.min().resize(stat.min.size());
+                param.max().resize(stat.max.size());
+                for (size_t c = 0; c < stat.min.size(); ++c)
+                {
+                    param.min()[c] = std::min(std::max(stat.min[c], -threshold), threshold);
+                    param.max()[c] = std::min(std::max(stat.max[c], -threshold), threshold);
+                }
+                statistics.push_back(param);
+            }
+        }
+
+    private:
+        typedef std::vector<uint64_t> Histogram;
+
+        struct Statistic
+        {
+            Floats min, max;
+            float absMax;
+            Histogram histogram;
+        };
+        typedef std::map<String, Statistic> StatMap;
+
+        CalibrationType _type;
+        float _percentile;
+        size_t _bins, _pass;
+        Strings _names;
+        StatMap _stats;
+
+        static void GetLayout(const Tensor<float> & tensor, size_t & channels, size_t & inner)
+        {
+            const Shape & shape = tensor.Shape();
+            channels = 0, inner = 1;
+            if (tensor.Size() == 0)
+                return;
+            if (shape.size() < 2 || (tensor.Format() != TensorFormatNchw && tensor.Format() != TensorFormatNhwc && tensor.Format() != TensorFormatUnknown))
+                channels = 1, inner = tensor.Size();
+            else if (tensor.Format() == TensorFormatNhwc)
+                channels = shape.back();
+            else
+                channels = shape[1], inner = tensor.Size(2);
+        }
+
+        static void UpdateMinMax(const Tensor<float> & tensor, size_t channels, size_t inner, float * min, float * max)
+        {
+            const float * src = tensor.CpuData();
+            size_t outer = tensor.Size() / channels / inner;
+            for (size_t o = 0; o < outer; ++o)
+            {
+                if (inner == 1)
+                {
+                    for (size_t c = 0; c < channels; ++c)
+                    {
+                        min[c] = std::min(min[c], src[c]);
+                        max[c] = std::max(max[c], src[c]);
+                    }
+                    src += channels;
+                }
+                else
+                {
+                    for (size_t c = 0; c < channels; ++c)
+                    {
+                        float _min = min[c], _max = max[c];
+                        for (size_t i = 0; i < inner; ++i)
+                        {
+                            _min = std::min(_min, src[i]);
+                            _max = std::max(_max, src[i]);
+                        }
+                        min[c] = _min, max[c] = _max;
+                        src += inner;
+                    }
+                }
+            }
+        }
+
+        void UpdateHistogram(const Tensor<float> & tensor, Statistic & stat) const
+        {
+            if (stat.absMax <= 0.0f)
+                return;
+            const float * src = tensor.CpuData();
+            float scale = float(_bins) / stat.absMax;
+            uint64_t * hist = stat.histogram.data();
+            for (size_t i = 0, n = tensor.Size(); i < n; ++i)
+                hist[std::min(size_t(::fabs(src[i]) * scale), _bins - 1)]++;
+        }
+
+        float Threshold(const Statistic & stat) const
+        {
+            if (stat.histogram.empty() || stat.absMax <= 0.0f)
+                return FLT_MAX;
+            const Histogram & hist = stat.histogram;
+            size_t edge = _bins;
+            if (_type == CalibrationPercentile)
+                edge = PercentileEdge(hist, _percentile);
+            if (_type == CalibrationEntropy)
+            {
+                bool negative = false;
+                for (size_t c = 0; c < stat.min.size(); ++c)
+                    negative = negative || stat.min[c] < 0.0f;
+                edge = EntropyEdge(hist, negative ? 128 : 256);
+            }
+            return stat.absMax * float(edge) / float(_bins);
+        }
+
+        static size_t PercentileEdge(const Histogram & hist, float percentile)
+        {
+            uint64_t total = 0, sum = 0;
+            for (size_t i = 0; i < hist.size(); ++i)
+                total += hist[i];
+            double bound = double(total) * std::min(std::max(percentile, 0.0f), 100.0f) / 100.0;
+            for (size_t i = 0; i < hist.size(); ++i)
+            {
+                sum += hist[i];
+                if (double(sum) >= bound)
+                    return i + 1;
+            }
+            return hist.size();
+        }
+
+        static size_t EntropyEdge(const Histogram & hist, size_t levels)
+        {
+            size_t bins = hist.size(), best = bins;
+            if (bins <= levels)
+                return bins;
+            uint64_t outliers = 0;
+            for (size_t i = levels; i < bins; ++i)
+                outliers += hist[i];
+            std::vector<double> p(bins), q(bins);
+            double min = DBL_MAX;
+            for (size_t edge = levels; edge <= bins; ++edge)
+            {
+                for (size_t i = 0; i < edge; ++i)
+                    p[i] = double(hist[i]);
+                p[edge - 1] += double(outliers);
+                if (edge < bins)
+                    outliers -= hist[edge];
+                for (size_t l = 0; l < levels; ++l)
+                {
+                    size_t beg = l * edge / levels, end = (l + 1) * edge / levels;
+                    double sum = 0;
+                    size_t nonZero = 0;
+                    for (size_t i = beg; i < end; ++i)
+                    {
+                        sum += double(hist[i]);
+                        nonZero += p[i] > 0 ? 1 : 0;
+                    }
+                    for (size_t i = beg; i < end; ++i)
+                        q[i] = p[i] > 0 ? sum / double(nonZero) : 0.0;
+                }
+                double sumP = 0, sumQ = 0;
+                for (size_t i = 0; i < edge; ++i)
+                    sumP += p[i], sumQ += q[i];
+                if (sumP == 0 || sumQ == 0)
+                    continue;
+                double divergence = 0;
+                for (size_t i = 0; i < edge; ++i)
+                {
+                    if (p[i] > 0)
+                        divergence += p[i] / sumP * ::log((p[i] / sumP) / std::max(q[i] / sumQ, 1e-10));
+                }
+                if (divergence < min)
+                {
+                    min = divergence;
+                    best = edge;
+                }
+            }
+            return best;
+        }
+    };
+}
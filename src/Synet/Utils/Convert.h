@@ -133,6 +133,16 @@ namespace Synet
 #endif
         }
 
+        SYNET_INLINE void Convert32iTo(int32_t value, float scale, float shift, uint8_t & dst)
+        {
+            dst = Convert32iTo8u(value, scale, shift);
+        }
+
+        SYNET_INLINE void Convert32iTo(int32_t value, float scale, float shift, float & dst)
+        {
+            dst = Convert32iTo32f(value, scale, shift);
+        }
+
         inline void Convert32iTo32fNchw(const int32_t * src, size_t channels, size_t spatial, const float * scale, const float * shift, float * dst)
         {
             for (size_t c = 0; c < channels; ++c)
@@ -0,0 +1,214 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Common.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+
+namespace Synet
+{
+    // Runs a DAG of layer stages on a fixed set of workers. Every worker has its own deque: it pops ready nodes from the back
+    // (LIFO, keeps a branch on one core) and steals from the front of other deques when its own one is empty.
+    // All deques and dependency counters are guarded by a single mutex instead of lock-free Chase-Lev deques:
+    // a node is a whole layer (tens of microseconds and more), so one lock per node is not a measurable cost,
+    // while it keeps the wake-up logic and the dependency counters simple.
+    class Executor
+    {
+    public:
+        typedef std::vector<size_t> Indices;
+        typedef std::vector<Indices> Graph;
+        typedef std::function<void(size_t node, size_t worker)> Function;
+
+        Executor()
+            : _stop(false)
+            , _generation(0)
+            , _remain(0)
+            , _function(NULL)
+#ifdef SYNET_ALLOCATION_CHECK
+            , _allocations(NULL)
+#endif
+        {
+        }
+
+        ~Executor()
+        {
+            Stop();
+        }
+
+        size_t Workers() const
+        {
+            return _queues.size();
+        }
+
+        void Init(size_t workers, const Graph & depends)
+        {
+            workers = std::max<size_t>(workers, 1);
+            if (workers != _queues.size())
+            {
+                Stop();
+                _queues.resize(workers);
+                for (size_t w = 1; w < workers; ++w)
+                    _threads.push_back(std::thread(&Executor::Loop, this, w));
+            }
+            _next.assign(depends.size(), Indices());
+            _depends.resize(depends.size());
+            _counts.resize(depends.size());
+            _roots.clear();
+            for (size_t i = 0; i < depends.size(); ++i)
+            {
+                _depends[i] = depends[i].size();
+                for (size_t j = 0; j < depends[i].size(); ++j)
+                    _next[depends[i][j]].push_back(i);
+                if (depends[i].empty())
+                    _roots.push_back(i);
+            }
+        }
+
+        void Run(const Function & function)
+        {
+            if (_roots.empty())
+                return;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _function = &function;
+#ifdef SYNET_ALLOCATION_CHECK
+                _allocations = Detail::ThreadAllocationCounter();
+#endif
+                _counts = _depends;
+                _remain = _counts.size();
+                for (size_t i = 0; i < _roots.size(); ++i)
+                    _queues[i % _queues.size()].push_back(_roots[i]);
+                _generation++;
+            }
+            _condition.notify_all();
+            Work(0);
+        }
+
+    private:
+        typedef std::deque<size_t> Queue;
+
+        std::vector<std::thread> _threads;
+        std::vector<Queue> _queues;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _stop;
+        size_t _generation, _remain;
+        const Function * _function;
+#ifdef SYNET_ALLOCATION_CHECK
+        Detail::AllocationCounter * _allocations;
+#endif
+        Graph _next;
+        Indices _depends, _counts, _roots;
+
+        void Stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _condition.notify_all();
+            for (size_t i = 0; i < _threads.size(); ++i)
+                _threads[i].join();
+            _threads.clear();
+            _queues.clear();
+            _stop = false;
+        }
+
+        void Loop(size_t worker)
+        {
+            size_t generation = 0;
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _condition.wait(lock, [&] { return _stop || _generation != generation; });
+                    if (_stop)
+                        return;
+                    generation = _generation;
+                }
+                Work(worker);
+            }
+        }
+
+        bool Pop(size_t worker, size_t & node)
+        {
+            if (_queues[worker].size())
+            {
+                node = _queues[worker].back();
+                _queues[worker].pop_back();
+                return true;
+            }
+            for (size_t i = 1; i < _queues.size(); ++i)
+            {
+                Queue & victim = _queues[(worker + i) % _queues.size()];
+                if (victim.size())
+                {
+                    node = victim.front();
+                    victim.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void Work(size_t worker)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            for (;;)
+            {
+                size_t node;
+                while (_remain && !_stop && !Pop(worker, node))
+                    _condition.wait(lock);
+                if (_remain == 0 || _stop)
+                    return;
+                lock.unlock();
+                {
+#ifdef SYNET_ALLOCATION_CHECK
+                    Detail::AllocationScope scope(_allocations);
+#endif
+                    (*_function)(node, worker);
+                }
+                lock.lock();
+                bool notify = --_remain == 0;
+                const Indices & next = _next[node];
+                for (size_t i = 0; i < next.size(); ++i)
+                {
+                    if (--_counts[next[i]] == 0)
+                    {
+                        _queues[worker].push_back(next[i]);
+                        notify = notify || _queues[worker].size() > 1;
+                    }
+                }
+                if (notify)
+                    _condition.notify_all();
+            }
+        }
+    };
+}
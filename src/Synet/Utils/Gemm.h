@@ -25,22 +25,37 @@
 #pragma once
 
 #include "Synet/Common.h"
+#include "Synet/Utils/Parallel.h"
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
 
 namespace Synet
 {
     namespace Detail
     {
-        template<class T> void CpuGemmNN(size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, const T * B, size_t ldb, T * C, size_t ldc)
+        template<class T> void CpuGemmBeta(size_t M, size_t N, T beta, T * C, size_t ldc)
         {
             for (size_t i = 0; i < M; ++i)
+                for (size_t j = 0; j < N; ++j)
+                    C[i*ldc + j] = beta == T(0) ? T(0) : C[i*ldc + j] * beta;
+        }
+
+        template<class T> void CpuGemmNN(size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, const T * B, size_t ldb, T * C, size_t ldc)
+        {
+            ParallelFor(0, M, [&](size_t begin, size_t end)
             {
-                for (size_t k = 0; k < K; ++k)
+                for (size_t i = begin; i < end; ++i)
                 {
-                    T a = alpha * A[i*lda + k];
-                    for (size_t j = 0; j < N; ++j)
-                        C[i*ldc + j] += a * B[k*ldb + j];
+                    for (size_t k = 0; k < K; ++k)
+                    {
+                        T a = alpha * A[i*lda + k];
+                        for (size_t j = 0; j < N; ++j)
+                            C[i*ldc + j] += a * B[k*ldb + j];
+                    }
                 }
-            }
+            }, ParallelGrain(N * K));
         }
 
         template<class T> void CpuGemmNT(size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, const T * B, size_t ldb, T * C, size_t ldc)
@@ -114,27 +129,298 @@ namespace Synet
         CblasConjNoTrans = 114,
     };
 
+    namespace Detail
+    {
+        template<class T> struct GemmKernel
+        {
+            static const size_t MR = 4, NR = 4, MC = 64, KC = 256, NC = 1024;
+
+            static SYNET_INLINE void Run(size_t K, T alpha, const T * A, const T * B, T beta, T * C, size_t ldc)
+            {
+                T c[MR][NR] = { { 0 } };
+                for (size_t k = 0; k < K; ++k, A += MR, B += NR)
+                    for (size_t i = 0; i < MR; ++i)
+                        for (size_t j = 0; j < NR; ++j)
+                            c[i][j] += A[i] * B[j];
+                for (size_t i = 0; i < MR; ++i, C += ldc)
+                    for (size_t j = 0; j < NR; ++j)
+                        C[j] = beta == T(0) ? alpha * c[i][j] : alpha * c[i][j] + beta * C[j];
+            }
+        };
+
+#if defined(__AVX2__)
+        SYNET_INLINE __m256 GemmFmadd(__m256 a, __m256 b, __m256 c)
+        {
+#if defined(__FMA__)
+            return _mm256_fmadd_ps(a, b, c);
+#else
+            return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+        }
+
+        SYNET_INLINE void GemmStore(float * C, __m256 c, __m256 alpha, __m256 beta, bool zero)
+        {
+            c = _mm256_mul_ps(alpha, c);
+            _mm256_storeu_ps(C, zero ? c : GemmFmadd(beta, _mm256_loadu_ps(C), c));
+        }
+
+        template<> struct GemmKernel<float>
+        {
+            static const size_t MR = 6, NR = 16, MC = 120, KC = 256, NC = 2048;
+
+            static SYNET_INLINE void Run(size_t K, float alpha, const float * A, const float * B, float beta, float * C, size_t ldc)
+            {
+                __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps(), c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+                __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps(), c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+                __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps(), c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+                for (size_t k = 0; k < K; ++k, A += MR, B += NR)
+                {
+                    __m256 b0 = _mm256_loadu_ps(B + 0), b1 = _mm256_loadu_ps(B + 8), a;
+                    a = _mm256_set1_ps(A[0]), c00 = GemmFmadd(a, b0, c00), c01 = GemmFmadd(a, b1, c01);
+                    a = _mm256_set1_ps(A[1]), c10 = GemmFmadd(a, b0, c10), c11 = GemmFmadd(a, b1, c11);
+                    a = _mm256_set1_ps(A[2]), c20 = GemmFmadd(a, b0, c20), c21 = GemmFmadd(a, b1, c21);
+                    a = _mm256_set1_ps(A[3]), c30 = GemmFmadd(a, b0, c30), c31 = GemmFmadd(a, b1, c31);
+                    a = _mm256_set1_ps(A[4]), c40 = GemmFmadd(a, b0, c40), c41 = GemmFmadd(a, b1, c41);
+                    a = _mm256_set1_ps(A[5]), c50 = GemmFmadd(a, b0, c50), c51 = GemmFmadd(a, b1, c51);
+                }
+                __m256 _alpha = _mm256_set1_ps(alpha), _beta = _mm256_set1_ps(beta);
+                bool zero = beta == 0.0f;
+                GemmStore(C + 0, c00, _alpha, _beta, zero), GemmStore(C + 8, c01, _alpha, _beta, zero), C += ldc;
+                GemmStore(C + 0, c10, _alpha, _beta, zero), GemmStore(C + 8, c11, _alpha, _beta, zero), C += ldc;
+                GemmStore(C + 0, c20, _alpha, _beta, zero), GemmStore(C + 8, c21, _alpha, _beta, zero), C += ldc;
+                GemmStore(C + 0, c30, _alpha, _beta, zero), GemmStore(C + 8, c31, _alpha, _beta, zero), C += ldc;
+                GemmStore(C + 0, c40, _alpha, _beta, zero), GemmStore(C + 8, c41, _alpha, _beta, zero), C += ldc;
+                GemmStore(C + 0, c50, _alpha, _beta, zero), GemmStore(C + 8, c51, _alpha, _beta, zero);
+            }
+        };
+#elif defined(__SSE4_1__)
+        SYNET_INLINE void GemmStore(float * C, __m128 c, __m128 alpha, __m128 beta, bool zero)
+        {
+            c = _mm_mul_ps(alpha, c);
+            _mm_storeu_ps(C, zero ? c : _mm_add_ps(_mm_mul_ps(beta, _mm_loadu_ps(C)), c));
+        }
+
+        template<> struct GemmKernel<float>
+        {
+            static const size_t MR = 4, NR = 8, MC = 128, KC = 256, NC = 2048;
+
+            static SYNET_INLINE void Run(size_t K, float alpha, const float * A, const float * B, float beta, float * C, size_t ldc)
+            {
+                __m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps(), c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+                __m128 c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps(), c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps();
+                for (size_t k = 0; k < K; ++k, A += MR, B += NR)
+                {
+                    __m128 b0 = _mm_loadu_ps(B + 0), b1 = _mm_loadu_ps(B + 4), a;
+                    a = _mm_set1_ps(A[0]), c00 = _mm_add_ps(_mm_mul_ps(a, b0), c00), c01 = _mm_add_ps(_mm_mul_ps(a, b1), c01);
+                    a = _mm_set1_ps(A[1]), c10 = _mm_add_ps(_mm_mul_ps(a, b0), c10), c11 = _mm_add_ps(_mm_mul_ps(a, b1), c11);
+                    a = _mm_set1_ps(A[2]), c20 = _mm_add_ps(_mm_mul_ps(a, b0), c20), c21 = _mm_add_ps(_mm_mul_ps(a, b1), c21);
+                    a = _mm_set1_ps(A[3]), c30 = _mm_add_ps(_mm_mul_ps(a, b0), c30), c31 = _mm_add_ps(_mm_mul_ps(a, b1), c31);
+                }
+                __m128 _alpha = _mm_set1_ps(alpha), _beta = _mm_set1_ps(beta);
+                bool zero = beta == 0.0f;
+                GemmStore(C + 0, c00, _alpha, _beta, zero), GemmStore(C + 4, c01, _alpha, _beta, zero), C += ldc;
+                GemmStore(C + 0, c10, _alpha, _beta, zero), GemmStore(C + 4, c11, _alpha, _beta, zero), C += ldc;
+                GemmStore(C + 0, c20, _alpha, _beta, zero), GemmStore(C + 4, c21, _alpha, _beta, zero), C += ldc;
+                GemmStore(C + 0, c30, _alpha, _beta, zero), GemmStore(C + 4, c31, _alpha, _beta, zero);
+            }
+        };
+#endif
+
+        template<class T> T * GemmBuffer(size_t index, size_t size)
+        {
+            thread_local std::vector<T> buffers[2];
+            if (buffers[index].size() < size)
+                buffers[index].resize(size);
+            return buffers[index].data();
+        }
+
+        template<class T, size_t MR> void GemmPackA(const T * A, size_t lda, bool trans, size_t M, size_t K, T * dst)
+        {
+            for (size_t i = 0; i < M; i += MR)
+            {
+                size_t m = std::min(MR, M - i);
+                for (size_t k = 0; k < K; ++k, dst += MR)
+                {
+                    size_t r = 0;
+                    if (trans)
+                        for (const T * a = A + k * lda + i; r < m; ++r)
+                            dst[r] = a[r];
+                    else
+                        for (const T * a = A + i * lda + k; r < m; ++r)
+                            dst[r] = a[r * lda];
+                    for (; r < MR; ++r)
+                        dst[r] = T(0);
+                }
+            }
+        }
+
+        template<class T, size_t NR> void GemmPackB(const T * B, size_t ldb, bool trans, size_t N, size_t K, T * dst)
+        {
+            for (size_t j = 0; j < N; j += NR)
+            {
+                size_t n = std::min(NR, N - j);
+                for (size_t k = 0; k < K; ++k, dst += NR)
+                {
+                    size_t c = 0;
+                    if (trans)
+                        for (const T * b = B + j * ldb + k; c < n; ++c)
+                            dst[c] = b[c * ldb];
+                    else
+                        for (const T * b = B + k * ldb + j; c < n; ++c)
+                            dst[c] = b[c];
+                    for (; c < NR; ++c)
+                        dst[c] = T(0);
+                }
+            }
+        }
+
+        struct GemmNoPost
+        {
+            template<class T> SYNET_INLINE void operator()(size_t M, size_t N, T * C, size_t ldc) const
+            {
+            }
+        };
+
+        template<class T, class Post> void GemmBlock(bool transA, bool transB, size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, const T * packedA,
+            const T * B, size_t ldb, const T * packedB, T beta, T * C, size_t ldc, size_t m0, size_t m1, size_t n0, size_t n1, const Post & post)
+        {
+            typedef GemmKernel<T> Kernel;
+            const size_t MR = Kernel::MR, NR = Kernel::NR, MC = Kernel::MC, KC = Kernel::KC, NC = Kernel::NC;
+            const size_t MA = (M + MR - 1) / MR * MR, NB = (N + NR - 1) / NR * NR;
+            T * bufA = packedA ? NULL : GemmBuffer<T>(0, MC * KC);
+            T * bufB = packedB ? NULL : GemmBuffer<T>(1, KC * NC);
+            for (size_t n = n0; n < n1; n += NC)
+            {
+                size_t nc = std::min(NC, n1 - n);
+                for (size_t k = 0; k < K; k += KC)
+                {
+                    size_t kc = std::min(KC, K - k);
+                    const T * pB = packedB ? packedB + k * NB + n * kc : bufB;
+                    if (!packedB)
+                        GemmPackB<T, NR>(transB ? B + n * ldb + k : B + k * ldb + n, ldb, transB, nc, kc, bufB);
+                    T b = k == 0 ? beta : T(1);
+                    for (size_t m = m0; m < m1; m += MC)
+                    {
+                        size_t mc = std::min(MC, m1 - m);
+                        const T * pA = packedA ? packedA + k * MA + m * kc : bufA;
+                        if (!packedA)
+                            GemmPackA<T, MR>(transA ? A + k * lda + m : A + m * lda + k, lda, transA, mc, kc, bufA);
+                        for (size_t j = 0; j < nc; j += NR)
+                        {
+                            size_t nr = std::min(NR, nc - j);
+                            for (size_t i = 0; i < mc; i += MR)
+                            {
+                                size_t mr = std::min(MR, mc - i);
+                                T * c = C + (m + i) * ldc + n + j;
+                                if (mr == MR && nr == NR)
+                                    Kernel::Run(kc, alpha, pA + i * kc, pB + j * kc, b, c, ldc);
+                                else
+                                {
+                                    T tile[MR * NR];
+                                    Kernel::Run(kc, alpha, pA + i * kc, pB + j * kc, T(0), tile, NR);
+                                    for (size_t ii = 0; ii < mr; ++ii)
+                                        for (size_t jj = 0; jj < nr; ++jj)
+                                            c[ii * ldc + jj] = b == T(0) ? tile[ii * NR + jj] : tile[ii * NR + jj] + b * c[ii * ldc + jj];
+                                }
+                            }
+                        }
+                        if (k + kc == K)
+                            post(mc, nc, C + m * ldc + n, ldc);
+                    }
+                }
+            }
+        }
+
+        template<class T, class Post> void GemmEngine(bool transA, bool transB, size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, const T * packedA,
+            const T * B, size_t ldb, const T * packedB, T beta, T * C, size_t ldc, const Post & post)
+        {
+            typedef GemmKernel<T> Kernel;
+            if (K == 0)
+            {
+                for (size_t i = 0; i < M; ++i)
+                    for (size_t j = 0; j < N; ++j)
+                        C[i * ldc + j] = beta == T(0) ? T(0) : beta * C[i * ldc + j];
+                post(M, N, C, ldc);
+                return;
+            }
+            if (M == 1 && packedA == NULL && packedB == NULL)
+            {
+                for (size_t j = 0; j < N; ++j)
+                    C[j] = beta == T(0) ? T(0) : beta * C[j];
+                if (transA)
+                    transB ? CpuGemmTT(M, N, K, alpha, A, lda, B, ldb, C, ldc) : CpuGemmTN(M, N, K, alpha, A, lda, B, ldb, C, ldc);
+                else
+                    transB ? CpuGemmNT(M, N, K, alpha, A, lda, B, ldb, C, ldc) : CpuGemmNN(M, N, K, alpha, A, lda, B, ldb, C, ldc);
+                post(M, N, C, ldc);
+                return;
+            }
+            if (M >= N)
+            {
+                ParallelFor(0, (M + Kernel::MR - 1) / Kernel::MR, [&](size_t begin, size_t end)
+                {
+                    GemmBlock(transA, transB, M, N, K, alpha, A, lda, packedA, B, ldb, packedB, beta, C, ldc, begin * Kernel::MR, std::min(end * Kernel::MR, M), 0, N, post);
+                }, ParallelGrain(Kernel::MR * N * K));
+            }
+            else
+            {
+                ParallelFor(0, (N + Kernel::NR - 1) / Kernel::NR, [&](size_t begin, size_t end)
+                {
+                    GemmBlock(transA, transB, M, N, K, alpha, A, lda, packedA, B, ldb, packedB, beta, C, ldc, 0, M, begin * Kernel::NR, std::min(end * Kernel::NR, N), post);
+                }, ParallelGrain(Kernel::NR * M * K));
+            }
+        }
+    }
+
     template <typename T> void CpuGemm(CblasTranspose transA, CblasTranspose transB,
         size_t M, size_t N, size_t K, T alpha, const T * A, size_t lda, const T * B, size_t ldb, T beta, T * C, size_t ldc)
     {
-        for (size_t i = 0; i < M; ++i)
-            for (size_t j = 0; j < N; ++j)
-                C[i*ldc + j] *= beta;
+        Detail::GemmEngine(transA == CblasTrans, transB == CblasTrans, M, N, K, alpha, A, lda, (const T*)NULL, B, ldb, (const T*)NULL, beta, C, ldc, Detail::GemmNoPost());
+    }
 
-        if (transA == CblasNoTrans && transB == CblasNoTrans)
-            Detail::CpuGemmNN(M, N, K, alpha, A, lda, B, ldb, C, ldc);
-        if (transA == CblasTrans && transB == CblasNoTrans)
-            Detail::CpuGemmTN(M, N, K, alpha, A, lda, B, ldb, C, ldc);
-        if (transA == CblasNoTrans && transB == CblasTrans)
-            Detail::CpuGemmNT(M, N, K, alpha, A, lda, B, ldb, C, ldc);
-        if (transA == CblasTrans && transB == CblasTrans)
-            Detail::CpuGemmTT(M, N, K, alpha, A, lda, B, ldb, C, ldc);
+    template <typename T> size_t CpuGemmPackedSizeA(size_t M, size_t K)
+    {
+        const size_t MR = Detail::GemmKernel<T>::MR;
+        return (M + MR - 1) / MR * MR * K;
+    }
+
+    template <typename T> size_t CpuGemmPackedSizeB(size_t N, size_t K)
+    {
+        const size_t NR = Detail::GemmKernel<T>::NR;
+        return (N + NR - 1) / NR * NR * K;
+    }
+
+    template <typename T> void CpuGemmPackA(CblasTranspose transA, size_t M, size_t K, const T * A, size_t lda, T * packedA)
+    {
+        typedef Detail::GemmKernel<T> Kernel;
+        const size_t MR = Kernel::MR, KC = Kernel::KC, MA = (M + MR - 1) / MR * MR;
+        for (size_t k = 0; k < K; k += KC)
+            Detail::GemmPackA<T, Kernel::MR>(transA == CblasTrans ? A + k * lda : A + k, lda, transA == CblasTrans, M, std::min(KC, K - k), packedA + k * MA);
+    }
+
+    template <typename T> void CpuGemmPackB(CblasTranspose transB, size_t N, size_t K, const T * B, size_t ldb, T * packedB)
+    {
+        typedef Detail::GemmKernel<T> Kernel;
+        const size_t NR = Kernel::NR, KC = Kernel::KC, NB = (N + NR - 1) / NR * NR;
+        for (size_t k = 0; k < K; k += KC)
+            Detail::GemmPackB<T, Kernel::NR>(transB == CblasTrans ? B + k : B + k * ldb, ldb, transB == CblasTrans, N, std::min(KC, K - k), packedB + k * NB);
+    }
+
+    template <typename T> void CpuGemmPacked(CblasTranspose transA, CblasTranspose transB, size_t M, size_t N, size_t K, T alpha, 
+        const T * A, size_t lda, const T * packedA, const T * B, size_t ldb, const T * packedB, T beta, T * C, size_t ldc)
+    {
+        Detail::GemmEngine(transA == CblasTrans, transB == CblasTrans, M, N, K, alpha, A, lda, packedA, B, ldb, packedB, beta, C, ldc, Detail::GemmNoPost());
+    }
+
+    // Calls post(rows, cols, C + offset, ldc) for every MC x NC block of C once its final value is stored, while the block is still in cache.
+    template <typename T, class Post> void CpuGemmPacked(CblasTranspose transA, CblasTranspose transB, size_t M, size_t N, size_t K, T alpha,
+        const T * A, size_t lda, const T * packedA, const T * B, size_t ldb, const T * packedB, T beta, T * C, size_t ldc, const Post & post)
+    {
+        Detail::GemmEngine(transA == CblasTrans, transB == CblasTrans, M, N, K, alpha, A, lda, packedA, B, ldb, packedB, beta, C, ldc, post);
     }
 
     template <typename T> void CpuGemv(CblasTranspose transA, size_t M, size_t N, T alpha, const T * A, const T * x, T beta, T * y)
     {
-        for (size_t i = 0; i < M; ++i)
-            y[i] *= beta;
+        Detail::CpuGemmBeta(1, M, beta, y, M);
 
         if (transA == CblasNoTrans)
             Detail::CpuGemvN(M, N, alpha, A, x, y);
@@ -144,17 +430,235 @@ namespace Synet
 
     template < class TA, class TB> inline void CpuGemmNN(size_t M, size_t N, size_t K, const TA * A, size_t lda, const TB * B, size_t ldb, int32_t * C, size_t ldc)
     {
-        for (size_t i = 0; i < M; ++i)
+        ParallelFor(0, M, [&](size_t begin, size_t end)
         {
-            for (size_t j = 0; j < N; ++j)
-                C[i*ldc + j] = 0;
-            for (size_t k = 0; k < K; ++k)
+            for (size_t i = begin; i < end; ++i)
             {
-                int32_t a = A[i*lda + k];
                 for (size_t j = 0; j < N; ++j)
-                    C[i*ldc + j] += a * B[k*ldb + j];
+                    C[i*ldc + j] = 0;
+                for (size_t k = 0; k < K; ++k)
+                {
+                    int32_t a = A[i*lda + k];
+                    for (size_t j = 0; j < N; ++j)
+                        C[i*ldc + j] += a * B[k*ldb + j];
+                }
+            }
+        }, ParallelGrain(N * K));
+    }
+
+    namespace Detail
+    {
+        template<class T> SYNET_INLINE int32_t Gemm8iLoad(const T * p)
+        {
+            int32_t value;
+            memcpy(&value, p, 4);
+            return value;
+        }
+
+        SYNET_INLINE int32_t Gemm8iPair(int32_t a0, int32_t b0, int32_t a1, int32_t b1)
+        {
+            int32_t sum = a0 * b0 + a1 * b1;
+#if defined(SYNET_INT8_INT16_OWERFLOW)
+            sum = std::min(std::max(SHRT_MIN, sum), SHRT_MAX);
+#endif
+            return sum;
+        }
+
+#if defined(__AVX2__)
+        SYNET_INLINE __m256i Gemm8iMadd(__m256i sum, __m256i u8, __m256i s8)
+        {
+#if defined(SYNET_INT8_INT16_OWERFLOW)
+            return _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(u8, s8), _mm256_set1_epi16(1)));
+#elif defined(__AVX512VNNI__) && defined(__AVX512VL__)
+            return _mm256_dpbusd_epi32(sum, u8, s8);
+#else
+            __m256i u0 = _mm256_and_si256(u8, _mm256_set1_epi16(0xFF)), u1 = _mm256_srli_epi16(u8, 8);
+            __m256i s0 = _mm256_srai_epi16(_mm256_slli_epi16(s8, 8), 8), s1 = _mm256_srai_epi16(s8, 8);
+            return _mm256_add_epi32(sum, _mm256_add_epi32(_mm256_madd_epi16(u0, s0), _mm256_madd_epi16(u1, s1)));
+#endif
+        }
+
+        template<class TA> SYNET_INLINE __m256i Gemm8iMadd(__m256i sum, __m256i a, __m256i b);
+
+        template<> SYNET_INLINE __m256i Gemm8iMadd<uint8_t>(__m256i sum, __m256i a, __m256i b)
+        {
+            return Gemm8iMadd(sum, a, b);
+        }
+
+        template<> SYNET_INLINE __m256i Gemm8iMadd<int8_t>(__m256i sum, __m256i a, __m256i b)
+        {
+            return Gemm8iMadd(sum, b, a);
+        }
+
+        const size_t GEMM8I_MR = 4, GEMM8I_NR = 16, GEMM8I_MC = 64;
+
+        template<class TA, class TB> SYNET_INLINE void Gemm8iKernel(size_t Q, const TA * const * A, const TB * B, int32_t * C, size_t ldc)
+        {
+            __m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256(), c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256();
+            __m256i c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256(), c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256();
+            for (size_t q = 0, o = 0; q < Q; ++q, o += 4, B += GEMM8I_NR * 4)
+            {
+                __m256i b0 = _mm256_loadu_si256((__m256i*)B + 0), b1 = _mm256_loadu_si256((__m256i*)B + 1), a;
+                a = _mm256_set1_epi32(Gemm8iLoad(A[0] + o)), c00 = Gemm8iMadd<TA>(c00, a, b0), c01 = Gemm8iMadd<TA>(c01, a, b1);
+                a = _mm256_set1_epi32(Gemm8iLoad(A[1] + o)), c10 = Gemm8iMadd<TA>(c10, a, b0), c11 = Gemm8iMadd<TA>(c11, a, b1);
+                a = _mm256_set1_epi32(Gemm8iLoad(A[2] + o)), c20 = Gemm8iMadd<TA>(c20, a, b0), c21 = Gemm8iMadd<TA>(c21, a, b1);
+                a = _mm256_set1_epi32(Gemm8iLoad(A[3] + o)), c30 = Gemm8iMadd<TA>(c30, a, b0), c31 = Gemm8iMadd<TA>(c31, a, b1);
             }
+            _mm256_storeu_si256((__m256i*)C + 0, c00), _mm256_storeu_si256((__m256i*)C + 1, c01), C += ldc;
+            _mm256_storeu_si256((__m256i*)C + 0, c10), _mm256_storeu_si256((__m256i*)C + 1, c11), C += ldc;
+            _mm256_storeu_si256((__m256i*)C + 0, c20), _mm256_storeu_si256((__m256i*)C + 1, c21), C += ldc;
+            _mm256_storeu_si256((__m256i*)C + 0, c30), _mm256_storeu_si256((__m256i*)C + 1, c31);
+        }
+#elif defined(__SSE4_1__)
+        SYNET_INLINE __m128i Gemm8iMadd(__m128i sum, __m128i u8, __m128i s8)
+        {
+#if defined(SYNET_INT8_INT16_OWERFLOW)
+            return _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(u8, s8), _mm_set1_epi16(1)));
+#else
+            __m128i u0 = _mm_and_si128(u8, _mm_set1_epi16(0xFF)), u1 = _mm_srli_epi16(u8, 8);
+            __m128i s0 = _mm_srai_epi16(_mm_slli_epi16(s8, 8), 8), s1 = _mm_srai_epi16(s8, 8);
+            return _mm_add_epi32(sum, _mm_add_epi32(_mm_madd_epi16(u0, s0), _mm_madd_epi16(u1, s1)));
+#endif
+        }
+
+        template<class TA> SYNET_INLINE __m128i Gemm8iMadd(__m128i sum, __m128i a, __m128i b);
+
+        template<> SYNET_INLINE __m128i Gemm8iMadd<uint8_t>(__m128i sum, __m128i a, __m128i b)
+        {
+            return Gemm8iMadd(sum, a, b);
         }
+
+        template<> SYNET_INLINE __m128i Gemm8iMadd<int8_t>(__m128i sum, __m128i a, __m128i b)
+        {
+            return Gemm8iMadd(sum, b, a);
+        }
+
+        const size_t GEMM8I_MR = 4, GEMM8I_NR = 8, GEMM8I_MC = 64;
+
+        template<class TA, class TB> SYNET_INLINE void Gemm8iKernel(size_t Q, const TA * const * A, const TB * B, int32_t * C, size_t ldc)
+        {
+            __m128i c00 = _mm_setzero_si128(), c01 = _mm_setzero_si128(), c10 = _mm_setzero_si128(), c11 = _mm_setzero_si128();
+            __m128i c20 = _mm_setzero_si128(), c21 = _mm_setzero_si128(), c30 = _mm_setzero_si128(), c31 = _mm_setzero_si128();
+            for (size_t q = 0, o = 0; q < Q; ++q, o += 4, B += GEMM8I_NR * 4)
+            {
+                __m128i b0 = _mm_loadu_si128((__m128i*)B + 0), b1 = _mm_loadu_si128((__m128i*)B + 1), a;
+                a = _mm_set1_epi32(Gemm8iLoad(A[0] + o)), c00 = Gemm8iMadd<TA>(c00, a, b0), c01 = Gemm8iMadd<TA>(c01, a, b1);
+                a = _mm_set1_epi32(Gemm8iLoad(A[1] + o)), c10 = Gemm8iMadd<TA>(c10, a, b0), c11 = Gemm8iMadd<TA>(c11, a, b1);
+                a = _mm_set1_epi32(Gemm8iLoad(A[2] + o)), c20 = Gemm8iMadd<TA>(c20, a, b0), c21 = Gemm8iMadd<TA>(c21, a, b1);
+                a = _mm_set1_epi32(Gemm8iLoad(A[3] + o)), c30 = Gemm8iMadd<TA>(c30, a, b0), c31 = Gemm8iMadd<TA>(c31, a, b1);
+            }
+            _mm_storeu_si128((__m128i*)C + 0, c00), _mm_storeu_si128((__m128i*)C + 1, c01), C += ldc;
+            _mm_storeu_si128((__m128i*)C + 0, c10), _mm_storeu_si128((__m128i*)C + 1, c11), C += ldc;
+            _mm_storeu_si128((__m128i*)C + 0, c20), _mm_storeu_si128((__m128i*)C + 1, c21), C += ldc;
+            _mm_storeu_si128((__m128i*)C + 0, c30), _mm_storeu_si128((__m128i*)C + 1, c31);
+        }
+#else
+        const size_t GEMM8I_MR = 4, GEMM8I_NR = 4, GEMM8I_MC = 64;
+
+        template<class TA, class TB> SYNET_INLINE void Gemm8iKernel(size_t Q, const TA * const * A, const TB * B, int32_t * C, size_t ldc)
+        {
+            int32_t c[GEMM8I_MR][GEMM8I_NR] = { { 0 } };
+            for (size_t q = 0, o = 0; q < Q; ++q, o += 4, B += GEMM8I_NR * 4)
+                for (size_t i = 0; i < GEMM8I_MR; ++i)
+                {
+                    const TA * a = A[i] + o;
+                    for (size_t j = 0; j < GEMM8I_NR; ++j)
+                    {
+                        const TB * b = B + j * 4;
+                        c[i][j] += Gemm8iPair(a[0], b[0], a[1], b[1]) + Gemm8iPair(a[2], b[2], a[3], b[3]);
+                    }
+                }
+            for (size_t i = 0; i < GEMM8I_MR; ++i, C += ldc)
+                for (size_t j = 0; j < GEMM8I_NR; ++j)
+                    C[j] = c[i][j];
+        }
+#endif
+    }
+
+    inline void CpuGemm8iOrder(size_t K, size_t C, bool trans, Ints & order)
+    {
+        order.clear();
+        for (size_t k = 0; k < K; ++k)
+        {
+            for (size_t c = 0; c < C; c += 2)
+            {
+                order.push_back(int(trans ? k * C + c : c * K + k));
+                order.push_back(c + 1 < C ? int(trans ? k * C + c + 1 : (c + 1) * K + k) : -1);
+            }
+        }
+        while (order.size() % 4)
+            order.push_back(-1);
+    }
+
+    inline bool CpuGemm8iOrderIsIdentity(const Ints & order)
+    {
+        for (size_t i = 0; i < order.size(); ++i)
+            if (order[i] != int(i))
+                return false;
+        return true;
+    }
+
+    inline size_t CpuGemm8iPackedSizeB(size_t N, size_t Q)
+    {
+        const size_t NR = Detail::GEMM8I_NR;
+        return (N + NR - 1) / NR * NR * Q * 4;
+    }
+
+    template <class T> void CpuGemm8iPackA(size_t M, const Ints & order, const T * A, size_t lda, T * packedA)
+    {
+        for (size_t i = 0; i < M; ++i, A += lda)
+            for (size_t o = 0; o < order.size(); ++o)
+                *packedA++ = order[o] < 0 ? T(0) : A[order[o]];
+    }
+
+    template <class T> void CpuGemm8iPackB(size_t N, const Ints & order, const T * B, size_t ldb, T * packedB)
+    {
+        const size_t NR = Detail::GEMM8I_NR;
+        for (size_t j = 0; j < N; j += NR)
+        {
+            size_t n = std::min(NR, N - j);
+            for (size_t o = 0; o < order.size(); o += 4, packedB += NR * 4)
+            {
+                for (size_t c = 0; c < NR; ++c)
+                    for (size_t b = 0; b < 4; ++b)
+                        packedB[c * 4 + b] = c < n && order[o + b] >= 0 ? B[order[o + b] * ldb + j + c] : T(0);
+            }
+        }
+    }
+
+    template <class TA, class TB> void CpuGemm8i(size_t M, size_t N, size_t Q, const TA * A, size_t lda, const TB * packedB, int32_t * C, size_t ldc)
+    {
+        const size_t MR = Detail::GEMM8I_MR, NR = Detail::GEMM8I_NR, MC = Detail::GEMM8I_MC;
+        ParallelFor(0, (M + MC - 1) / MC, [&](size_t begin, size_t end)
+        {
+            for (size_t m = begin * MC, me = std::min(end * MC, M); m < me; m += MC)
+            {
+                size_t mc = std::min(MC, me - m);
+                for (size_t j = 0; j < N; j += NR)
+                {
+                    size_t nr = std::min(NR, N - j);
+                    const TB * b = packedB + j * Q * 4;
+                    for (size_t i = m; i < m + mc; i += MR)
+                    {
+                        size_t mr = std::min(MR, m + mc - i);
+                        const TA * a[MR];
+                        for (size_t r = 0; r < MR; ++r)
+                            a[r] = A + (i + std::min(r, mr - 1)) * lda;
+                        int32_t * c = C + i * ldc + j;
+                        if (mr == MR && nr == NR)
+                            Detail::Gemm8iKernel(Q, a, b, c, ldc);
+                        else
+                        {
+                            int32_t tile[MR * NR];
+                            Detail::Gemm8iKernel(Q, a, b, tile, NR);
+                            for (size_t ii = 0; ii < mr; ++ii)
+                                for (size_t jj = 0; jj < nr; ++jj)
+                                    c[ii * ldc + jj] = tile[ii * NR + jj];
+                        }
+                    }
+                }
+            }
+        }, ParallelGrain(MC * N * Q * 4));
     }
 
 #if defined(SYNET_SIMD_LIBRARY_ENABLE)
@@ -171,13 +675,7 @@ namespace Synet
         }
         else
         {
-            for (size_t i = 0; i < M; ++i)
-                for (size_t j = 0; j < N; ++j)
-                    C[i*ldc + j] *= beta;
-            if (transA == CblasTrans && transB == CblasNoTrans)
-                Detail::CpuGemmTN(M, N, K, alpha, A, lda, B, ldb, C, ldc);
-            if (transA == CblasTrans && transB == CblasTrans)
-                Detail::CpuGemmTT(M, N, K, alpha, A, lda, B, ldb, C, ldc);
+            Detail::GemmEngine(transA == CblasTrans, transB == CblasTrans, M, N, K, alpha, A, lda, (const float*)NULL, B, ldb, (const float*)NULL, beta, C, ldc, Detail::GemmNoPost());
         }
     }
 #endif
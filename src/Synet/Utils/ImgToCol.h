@@ -25,6 +25,7 @@
 #pragma once
 
 #include "Synet/Common.h"
+#include "Synet/Utils/Parallel.h"
 
 namespace Synet
 {
@@ -43,104 +44,109 @@ namespace Synet
 
         size_t dstH = (srcH + padY + padH - (dilationY * (kernelY - 1) + 1)) / strideY + 1;
         size_t dstW = (srcW + padX + padW - (dilationX * (kernelX - 1) + 1)) / strideX + 1;
-        size_t srcSize = srcW * srcH;
-        if (dilationX == 1 && dilationY == 1 && strideX == 2 && strideY == 2 && padX == 0 && padY == 0 && padW == 0 && padH == 0 && kernelX == 1 && kernelY == 1)
+        size_t srcSize = srcW * srcH, dstSize = kernelY * kernelX * dstH * dstW;
+        ParallelFor(0, srcC, [&](size_t begin, size_t end)
         {
-            for (size_t channel = 0; channel < srcC; ++channel)
+            const T * ps = src + begin * srcSize;
+            T * pd = dst + begin * dstSize;
+            if (dilationX == 1 && dilationY == 1 && strideX == 2 && strideY == 2 && padX == 0 && padY == 0 && padW == 0 && padH == 0 && kernelX == 1 && kernelY == 1)
             {
-                for (size_t dy = 0; dy < dstH; ++dy)
+                for (size_t channel = begin; channel < end; ++channel)
                 {
-                    const T * psrc = src + 2*dy*srcW;
-                    for (size_t dx = 0, sx = 0; dx < dstW; ++dx, sx += 2)
-                        *(dst++) = psrc[sx];
+                    for (size_t dy = 0; dy < dstH; ++dy)
+                    {
+                        const T * psrc = ps + 2 * dy*srcW;
+                        for (size_t dx = 0, sx = 0; dx < dstW; ++dx, sx += 2)
+                            *(pd++) = psrc[sx];
+                    }
+                    ps += srcSize;
                 }
-                src += srcSize;
             }
-        }
-        else if (dilationX*dilationY*strideX*strideY != 1)
-        {
-            for (size_t channel = 0; channel < srcC; ++channel)
+            else if (dilationX*dilationY*strideX*strideY != 1)
             {
-                for (size_t ky = 0; ky < kernelY; ky++)
+                for (size_t channel = begin; channel < end; ++channel)
                 {
-                    for (size_t kx = 0; kx < kernelX; kx++)
+                    for (size_t ky = 0; ky < kernelY; ky++)
                     {
-                        size_t sy = ky * dilationY - padY;
-                        for (size_t dy = 0; dy < dstH; ++dy)
+                        for (size_t kx = 0; kx < kernelX; kx++)
                         {
-                            if (sy < srcH)
+                            size_t sy = ky * dilationY - padY;
+                            for (size_t dy = 0; dy < dstH; ++dy)
                             {
-                                size_t sx = kx * dilationX - padX;
-                                for (size_t dx = 0; dx < dstW; ++dx)
+                                if (sy < srcH)
                                 {
-                                    if (sx < srcW)
-                                        *(dst++) = src[sy * srcW + sx];
-                                    else
-                                        *(dst++) = zero[channel];
-                                    sx += strideX;
+                                    size_t sx = kx * dilationX - padX;
+                                    for (size_t dx = 0; dx < dstW; ++dx)
+                                    {
+                                        if (sx < srcW)
+                                            *(pd++) = ps[sy * srcW + sx];
+                                        else
+                                            *(pd++) = zero[channel];
+                                        sx += strideX;
+                                    }
                                 }
+                                else
+                                {
+                                    for (size_t dx = 0; dx < dstW; ++dx)
+                                        *(pd++) = zero[channel];
+                                }
+                                sy += strideY;
                             }
-                            else
-                            {
-                                for (size_t dx = 0; dx < dstW; ++dx)
-                                    *(dst++) = zero[channel];
-                            }
-                            sy += strideY;
                         }
                     }
+                    ps += srcSize;
                 }
-                src += srcSize;
-            }        
-        }
-        else
-        {
-            const ptrdiff_t bodySize = dstW - padX - padW;
-            for (size_t channel = 0; channel < srcC; ++channel)
+            }
+            else
             {
-                for (size_t ky = 0; ky < kernelY; ++ky)
+                const ptrdiff_t bodySize = dstW - padX - padW;
+                for (size_t channel = begin; channel < end; ++channel)
                 {
-                    for (size_t kx = 0; kx < kernelX; ++kx)
+                    for (size_t ky = 0; ky < kernelY; ++ky)
                     {
-                        size_t sy = ky - padY;
-                        for (size_t dy = 0; dy < dstH; ++dy, ++sy)
+                        for (size_t kx = 0; kx < kernelX; ++kx)
                         {
-                            if (sy < srcH)
+                            size_t sy = ky - padY;
+                            for (size_t dy = 0; dy < dstH; ++dy, ++sy)
                             {
-                                size_t sx = kx - padX, dx = 0;
-                                const T * psrc = src + sy*srcW;
-                                for (; dx < padX; ++dx, ++sx)
+                                if (sy < srcH)
                                 {
-                                    if (sx < srcW)
-                                        *(dst++) = psrc[sx];
-                                    else
-                                        *(dst++) = zero[channel];
+                                    size_t sx = kx - padX, dx = 0;
+                                    const T * psrc = ps + sy * srcW;
+                                    for (; dx < padX; ++dx, ++sx)
+                                    {
+                                        if (sx < srcW)
+                                            *(pd++) = psrc[sx];
+                                        else
+                                            *(pd++) = zero[channel];
+                                    }
+                                    if (bodySize > 0)
+                                    {
+                                        memcpy(pd, psrc + sx, bodySize * sizeof(T));
+                                        pd += bodySize;
+                                        dx += bodySize;
+                                        sx += bodySize;
+                                    }
+                                    for (; dx < dstW; ++dx, ++sx)
+                                    {
+                                        if (sx < srcW)
+                                            *(pd++) = psrc[sx];
+                                        else
+                                            *(pd++) = zero[channel];
+                                    }
                                 }
-                                if (bodySize > 0)
+                                else
                                 {
-                                    memcpy(dst, psrc + sx, bodySize * sizeof(T));
-                                    dst += bodySize;
-                                    dx += bodySize;
-                                    sx += bodySize;
+                                    for (size_t dx = 0; dx < dstW; ++dx)
+                                        *(pd++) = zero[channel];
                                 }
-                                for (; dx < dstW; ++dx, ++sx)
-                                {
-                                    if (sx < srcW)
-                                        *(dst++) = psrc[sx];
-                                    else
-                                        *(dst++) = zero[channel];
-                                }
-                            }
-                            else
-                            {
-                                for (size_t dx = 0; dx < dstW; ++dx)
-                                    *(dst++) = zero[channel];
                             }
                         }
                     }
+                    ps += srcSize;
                 }
-                src += srcSize;
             }
-        }
+        }, ParallelGrain(dstSize));
     }
 
     template <typename T> void ImgToRow(const T * src, size_t srcH, size_t srcW, size_t srcC, size_t kernelY, size_t kernelX,
@@ -159,46 +165,51 @@ namespace Synet
         size_t dstH = (srcH + padY + padH - (dilationY * (kernelY - 1) + 1)) / strideY + 1;
         size_t dstW = (srcW + padX + padW - (dilationX * (kernelX - 1) + 1)) / strideX + 1;
 
-        size_t size = srcC / group;
+        size_t size = srcC / group, rowSize = dstW * kernelY * kernelX * size;
         for (size_t g = 0; g < group; ++g)
         {
-            for (size_t dy = 0; dy < dstH; ++dy)
+            ParallelFor(0, dstH, [&](size_t begin, size_t end)
             {
-                for (size_t dx = 0; dx < dstW; ++dx)
+                T * pd = dst + begin * rowSize;
+                for (size_t dy = begin; dy < end; ++dy)
                 {
-                    for (size_t ky = 0; ky < kernelY; ky++)
+                    for (size_t dx = 0; dx < dstW; ++dx)
                     {
-                        size_t sy = dy*strideY + ky * dilationY - padY;
-                        if (sy < srcH)
+                        for (size_t ky = 0; ky < kernelY; ky++)
                         {
-                            for (size_t kx = 0; kx < kernelX; kx++)
+                            size_t sy = dy*strideY + ky * dilationY - padY;
+                            if (sy < srcH)
                             {
-                                size_t sx = dx*strideX + kx * dilationX - padX;
-                                if (sx < srcW)
-                                {
-                                    memcpy(dst, src + (sy * srcW + sx)*srcC, size * sizeof(T));
-                                    dst += size;
-                                }
-                                else
+                                for (size_t kx = 0; kx < kernelX; kx++)
                                 {
-                                    memcpy(dst, zero, size * sizeof(T));
-                                    dst += size;
+                                    size_t sx = dx*strideX + kx * dilationX - padX;
+                                    if (sx < srcW)
+                                    {
+                                        memcpy(pd, src + (sy * srcW + sx)*srcC, size * sizeof(T));
+                                        pd += size;
+                                    }
+                                    else
+                                    {
+                                        memcpy(pd, zero, size * sizeof(T));
+                                        pd += size;
+                                    }
                                 }
                             }
-                        }
-                        else
-                        {
-                            for (size_t kx = 0; kx < kernelX; kx++)
+                            else
                             {
-                                memcpy(dst, zero, size * sizeof(T));
-                                dst += size;
+                                for (size_t kx = 0; kx < kernelX; kx++)
+                                {
+                                    memcpy(pd, zero, size * sizeof(T));
+                                    pd += size;
+                                }
                             }
                         }
                     }
                 }
-            }
+            }, ParallelGrain(rowSize));
             src += size;
             zero += size;
+            dst += dstH * rowSize;
         }
     }
 
@@ -25,6 +25,7 @@
 #pragma once
 
 #include "Synet/Common.h"
+#include "Synet/Utils/VectorMath.h"
 
 namespace Synet
 {
@@ -121,6 +122,18 @@ namespace Synet
             dst[i] = ::pow(src[i], exp);
     }
 
+    template <typename T> void CpuExp(const T * src, size_t size, T * dst)
+    {
+        for (size_t i = 0; i < size; ++i)
+            dst[i] = ::exp(src[i]);
+    }
+
+    template <typename T> void CpuLog(const T * src, size_t size, T * dst)
+    {
+        for (size_t i = 0; i < size; ++i)
+            dst[i] = ::log(src[i]);
+    }
+
     template <typename T> void CpuAdd(const T & value, T * dst, size_t size)
     {
         for (size_t i = 0; i < size; ++i)
@@ -180,6 +193,16 @@ namespace Synet
         return touched;
     }
 
+    template <> SYNET_INLINE void CpuExp<float>(const float * src, size_t size, float * dst)
+    {
+        VectorExp(src, size, dst);
+    }
+
+    template <> SYNET_INLINE void CpuLog<float>(const float * src, size_t size, float * dst)
+    {
+        VectorLog(src, size, dst);
+    }
+
 #ifdef SYNET_SIMD_LIBRARY_ENABLE
     template <> SYNET_INLINE void CpuSet<float>(size_t size, float value, float * dst)
     {
@@ -212,5 +235,10 @@ namespace Synet
         ::SimdNeuralProductSum(a, b, size, &sum);
         return sum;
     }
+#else
+    template <> SYNET_INLINE void CpuPow<float>(const float * src, size_t size, const float & exp, float * dst)
+    {
+        VectorPow(src, size, exp, dst);
+    }
 #endif
 }
\ No newline at end of file
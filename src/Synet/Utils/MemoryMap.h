@@ -0,0 +1,149 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Common.h"
+
+#ifdef _MSC_VER
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Synet
+{
+    class MemoryMap
+    {
+    public:
+        MemoryMap()
+            : _data(NULL)
+            , _size(0)
+#ifdef _MSC_VER
+            , _file(INVALID_HANDLE_VALUE)
+            , _mapping(NULL)
+#endif
+        {
+        }
+
+        ~MemoryMap()
+        {
+            Close();
+        }
+
+        bool Open(const String & path)
+        {
+            Close();
+#ifdef _MSC_VER
+            _file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (_file == INVALID_HANDLE_VALUE)
+                return false;
+            LARGE_INTEGER size;
+            bool result = ::GetFileSizeEx(_file, &size) != 0;
+            if (result && size.QuadPart)
+            {
+                _mapping = ::CreateFileMappingA(_file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+                _data = _mapping ? (char*)::MapViewOfFile(_mapping, FILE_MAP_COPY, 0, 0, 0) : NULL;
+                result = _data != NULL;
+            }
+            if (!result)
+            {
+                Close();
+                return false;
+            }
+            _size = (size_t)size.QuadPart;
+#else
+            int file = ::open(path.c_str(), O_RDONLY);
+            if (file == -1)
+                return false;
+            struct stat info;
+            if (::fstat(file, &info) == -1)
+            {
+                ::close(file);
+                return false;
+            }
+            _size = (size_t)info.st_size;
+            if (_size)
+            {
+                void * data = ::mmap(NULL, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+                if (data == MAP_FAILED)
+                {
+                    ::close(file);
+                    _size = 0;
+                    return false;
+                }
+                _data = (char*)data;
+            }
+            ::close(file);
+#endif
+            return true;
+        }
+
+        void Close()
+        {
+#ifdef _MSC_VER
+            if (_data)
+                ::UnmapViewOfFile(_data);
+            if (_mapping)
+                ::CloseHandle(_mapping);
+            if (_file != INVALID_HANDLE_VALUE)
+                ::CloseHandle(_file);
+            _mapping = NULL;
+            _file = INVALID_HANDLE_VALUE;
+#else
+            if (_data)
+                ::munmap(_data, _size);
+#endif
+            _data = NULL;
+            _size = 0;
+        }
+
+        const char * Data() const
+        {
+            return _data;
+        }
+
+        size_t Size() const
+        {
+            return _size;
+        }
+
+    private:
+        MemoryMap(const MemoryMap &);
+        MemoryMap & operator = (const MemoryMap &);
+
+        char * _data;
+        size_t _size;
+#ifdef _MSC_VER
+        HANDLE _file, _mapping;
+#endif
+    };
+
+    typedef std::shared_ptr<MemoryMap> MemoryMapPtr;
+}
@@ -0,0 +1,179 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Common.h"
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+namespace Synet
+{
+    const size_t PARALLEL_MIN_WORK = 16 * 1024;
+
+    namespace Detail
+    {
+        class ThreadPool
+        {
+        public:
+            struct Job
+            {
+                void(*run)(void * context, size_t begin, size_t end);
+                void * context;
+                size_t begin, end, count, next, done;
+#ifdef SYNET_ALLOCATION_CHECK
+                AllocationCounter * allocations;
+#endif
+            };
+
+            static ThreadPool & Global()
+            {
+                static ThreadPool pool;
+                return pool;
+            }
+
+            ~ThreadPool()
+            {
+                Resize(1);
+            }
+
+            void Run(Job & job)
+            {
+                Resize(GetThreadNumber());
+                std::unique_lock<std::mutex> lock(_mutex);
+                _jobs.push_back(&job);
+                _wake.notify_all();
+                while (job.next < job.count)
+                    Execute(job, lock);
+                while (job.done < job.count)
+                    _finish.wait(lock);
+            }
+
+        private:
+            std::vector<std::thread> _threads;
+            std::vector<Job*> _jobs;
+            std::mutex _mutex, _resize;
+            std::condition_variable _wake, _finish;
+            std::atomic<size_t> _size;
+            bool _stop;
+
+            ThreadPool()
+                : _size(1)
+                , _stop(false)
+            {
+                _jobs.reserve(64);
+            }
+
+            void Resize(size_t number)
+            {
+                number = std::max<size_t>(number, 1);
+                if (_size == number)
+                    return;
+                std::lock_guard<std::mutex> resize(_resize);
+                if (_size == number)
+                    return;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _stop = true;
+                }
+                _wake.notify_all();
+                for (size_t i = 0; i < _threads.size(); ++i)
+                    _threads[i].join();
+                _threads.clear();
+                _stop = false;
+                for (size_t i = 1; i < number; ++i)
+                    _threads.push_back(std::thread(&ThreadPool::Loop, this));
+                _size = number;
+            }
+
+            void Loop()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                for (;;)
+                {
+                    while (!_stop && _jobs.empty())
+                        _wake.wait(lock);
+                    if (_stop)
+                        return;
+                    Execute(*_jobs.front(), lock);
+                }
+            }
+
+            void Execute(Job & job, std::unique_lock<std::mutex> & lock)
+            {
+                size_t index = job.next++;
+                if (job.next == job.count)
+                    _jobs.erase(std::find(_jobs.begin(), _jobs.end(), &job));
+                lock.unlock();
+                {
+#ifdef SYNET_ALLOCATION_CHECK
+                    AllocationScope scope(job.allocations);
+#endif
+                    size_t size = job.end - job.begin;
+                    job.run(job.context, job.begin + size * index / job.count, job.begin + size * (index + 1) / job.count);
+                }
+                lock.lock();
+                if (++job.done == job.count)
+                    _finish.notify_all();
+            }
+        };
+
+        template<class Func> void ParallelRun(void * context, size_t begin, size_t end)
+        {
+            (*(Func*)context)(begin, end);
+        }
+    }
+
+    SYNET_INLINE size_t ParallelGrain(size_t work)
+    {
+        return std::max<size_t>(1, PARALLEL_MIN_WORK / std::max<size_t>(1, work));
+    }
+
+    template<class Func> void ParallelFor(size_t begin, size_t end, Func func, size_t grain = 1)
+    {
+        size_t size = end > begin ? end - begin : 0;
+        size_t count = std::min(GetThreadNumber(), (size + grain - 1) / std::max<size_t>(grain, 1));
+        if (count <= 1)
+        {
+            if (size)
+                func(begin, end);
+            return;
+        }
+        Detail::ThreadPool::Job job;
+        job.run = Detail::ParallelRun<Func>;
+        job.context = &func;
+        job.begin = begin;
+        job.end = end;
+        job.count = count;
+        job.next = 0;
+        job.done = 0;
+#ifdef SYNET_ALLOCATION_CHECK
+        job.allocations = Detail::ThreadAllocationCounter();
+#endif
+        Detail::ThreadPool::Global().Run(job);
+    }
+}
@@ -0,0 +1,200 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Common.h"
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace Synet
+{
+    const size_t PERMUTE_DIM_MAX = 6;
+
+    namespace Detail
+    {
+        template<class T> SYNET_INLINE void TransposeBlock(const T * src, size_t srcStride, size_t rows, size_t cols, T * dst, size_t dstStride)
+        {
+            for (size_t c = 0; c < cols; ++c)
+                for (size_t r = 0; r < rows; ++r)
+                    dst[c * dstStride + r] = src[r * srcStride + c];
+        }
+
+        template<class T> void Transpose2d(const T * src, size_t srcStride, size_t rows, size_t cols, T * dst, size_t dstStride)
+        {
+            const size_t tile = 16;
+            for (size_t c = 0; c < cols; c += tile)
+                for (size_t r = 0; r < rows; r += tile)
+                    TransposeBlock(src + r * srcStride + c, srcStride, std::min(tile, rows - r), std::min(tile, cols - c), dst + c * dstStride + r, dstStride);
+        }
+
+#if defined(__AVX2__)
+        SYNET_INLINE void Transpose8x8(const float * src, size_t srcStride, float * dst, size_t dstStride)
+        {
+            __m256 t0 = _mm256_unpacklo_ps(_mm256_loadu_ps(src + 0 * srcStride), _mm256_loadu_ps(src + 1 * srcStride));
+            __m256 t1 = _mm256_unpackhi_ps(_mm256_loadu_ps(src + 0 * srcStride), _mm256_loadu_ps(src + 1 * srcStride));
+            __m256 t2 = _mm256_unpacklo_ps(_mm256_loadu_ps(src + 2 * srcStride), _mm256_loadu_ps(src + 3 * srcStride));
+            __m256 t3 = _mm256_unpackhi_ps(_mm256_loadu_ps(src + 2 * srcStride), _mm256_loadu_ps(src + 3 * srcStride));
+            __m256 t4 = _mm256_unpacklo_ps(_mm256_loadu_ps(src + 4 * srcStride), _mm256_loadu_ps(src + 5 * srcStride));
+            __m256 t5 = _mm256_unpackhi_ps(_mm256_loadu_ps(src + 4 * srcStride), _mm256_loadu_ps(src + 5 * srcStride));
+            __m256 t6 = _mm256_unpacklo_ps(_mm256_loadu_ps(src + 6 * srcStride), _mm256_loadu_ps(src + 7 * srcStride));
+            __m256 t7 = _mm256_unpackhi_ps(_mm256_loadu_ps(src + 6 * srcStride), _mm256_loadu_ps(src + 7 * srcStride));
+            __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+            _mm256_storeu_ps(dst + 0 * dstStride, _mm256_permute2f128_ps(s0, s4, 0x20));
+            _mm256_storeu_ps(dst + 1 * dstStride, _mm256_permute2f128_ps(s1, s5, 0x20));
+            _mm256_storeu_ps(dst + 2 * dstStride, _mm256_permute2f128_ps(s2, s6, 0x20));
+            _mm256_storeu_ps(dst + 3 * dstStride, _mm256_permute2f128_ps(s3, s7, 0x20));
+            _mm256_storeu_ps(dst + 4 * dstStride, _mm256_permute2f128_ps(s0, s4, 0x31));
+            _mm256_storeu_ps(dst + 5 * dstStride, _mm256_permute2f128_ps(s1, s5, 0x31));
+            _mm256_storeu_ps(dst + 6 * dstStride, _mm256_permute2f128_ps(s2, s6, 0x31));
+            _mm256_storeu_ps(dst + 7 * dstStride, _mm256_permute2f128_ps(s3, s7, 0x31));
+        }
+#elif defined(__SSE4_1__)
+        SYNET_INLINE void Transpose4x4(const float * src, size_t srcStride, float * dst, size_t dstStride)
+        {
+            __m128 r0 = _mm_loadu_ps(src + 0 * srcStride);
+            __m128 r1 = _mm_loadu_ps(src + 1 * srcStride);
+            __m128 r2 = _mm_loadu_ps(src + 2 * srcStride);
+            __m128 r3 = _mm_loadu_ps(src + 3 * srcStride);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(dst + 0 * dstStride, r0);
+            _mm_storeu_ps(dst + 1 * dstStride, r1);
+            _mm_storeu_ps(dst + 2 * dstStride, r2);
+            _mm_storeu_ps(dst + 3 * dstStride, r3);
+        }
+#endif
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+        template<> SYNET_INLINE void Transpose2d<float>(const float * src, size_t srcStride, size_t rows, size_t cols, float * dst, size_t dstStride)
+        {
+#if defined(__AVX2__)
+            const size_t F = 8;
+#else
+            const size_t F = 4;
+#endif
+            const size_t tile = 64;
+            size_t rowsF = rows / F * F;
+            for (size_t cb = 0; cb < cols; cb += tile)
+            {
+                size_t ce = std::min(cb + tile, cols), ceF = cb + (ce - cb) / F * F;
+                for (size_t r = 0; r < rowsF; r += F)
+                {
+                    const float * s = src + r * srcStride;
+                    float * d = dst + r;
+                    for (size_t c = cb; c < ceF; c += F)
+#if defined(__AVX2__)
+                        Transpose8x8(s + c, srcStride, d + c * dstStride, dstStride);
+#else
+                        Transpose4x4(s + c, srcStride, d + c * dstStride, dstStride);
+#endif
+                    if (ceF < ce)
+                        TransposeBlock(s + ceF, srcStride, F, ce - ceF, d + ceF * dstStride, dstStride);
+                }
+                if (rowsF < rows)
+                    TransposeBlock(src + rowsF * srcStride + cb, srcStride, rows - rowsF, ce - cb, dst + cb * dstStride + rowsF, dstStride);
+            }
+        }
+#endif
+    }
+
+    template<class T> void CpuPermute(const T * src, const Shape & shape, const Shape & order, T * dst)
+    {
+        assert(shape.size() == order.size() && order.size() <= PERMUTE_DIM_MAX);
+        size_t srcStride[PERMUTE_DIM_MAX], size[PERMUTE_DIM_MAX], stride[PERMUTE_DIM_MAX], count = 0;
+        for (ptrdiff_t i = (ptrdiff_t)shape.size() - 1, s = 1; i >= 0; --i)
+        {
+            srcStride[i] = s;
+            s *= shape[i];
+        }
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            size_t a = order[i];
+            if (shape[a] == 1)
+                continue;
+            if (count && stride[count - 1] == srcStride[a] * shape[a])
+            {
+                size[count - 1] *= shape[a];
+                stride[count - 1] = srcStride[a];
+            }
+            else
+            {
+                size[count] = shape[a];
+                stride[count] = srcStride[a];
+                count++;
+            }
+        }
+        if (count == 0 || (count == 1 && stride[0] == 1))
+        {
+            memcpy(dst, src, (count ? size[0] : 1) * sizeof(T));
+            return;
+        }
+        size_t dstStride[PERMUTE_DIM_MAX];
+        for (ptrdiff_t i = count - 1, s = 1; i >= 0; --i)
+        {
+            dstStride[i] = s;
+            s *= size[i];
+        }
+        size_t inner = count - 1, outer = 0, total = 1;
+        while (stride[outer] != 1)
+            outer++;
+        size_t osize[PERMUTE_DIM_MAX], osrc[PERMUTE_DIM_MAX], odst[PERMUTE_DIM_MAX], index[PERMUTE_DIM_MAX], others = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i == inner || i == outer)
+                continue;
+            osize[others] = size[i];
+            osrc[others] = stride[i];
+            odst[others] = dstStride[i];
+            index[others] = 0;
+            total *= size[i];
+            others++;
+        }
+        for (size_t n = 0, s = 0, d = 0; n < total; ++n)
+        {
+            if (outer == inner)
+                memcpy(dst + d, src + s, size[inner] * sizeof(T));
+            else
+                Detail::Transpose2d(src + s, stride[inner], size[inner], size[outer], dst + d, dstStride[outer]);
+            for (ptrdiff_t i = others - 1; i >= 0; --i)
+            {
+                s += osrc[i];
+                d += odst[i];
+                if (++index[i] < osize[i])
+                    break;
+                s -= osrc[i] * osize[i];
+                d -= odst[i] * osize[i];
+                index[i] = 0;
+            }
+        }
+    }
+}
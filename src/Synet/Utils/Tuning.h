@@ -0,0 +1,128 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Common.h"
+
+#include <chrono>
+
+namespace Synet
+{
+    class TuningCache
+    {
+    public:
+        TuningCache()
+            : _changed(false)
+        {
+        }
+
+        bool Load(const String & path)
+        {
+            _path = path;
+            _map.clear();
+            _changed = false;
+            std::ifstream ifs(path.c_str());
+            if (!ifs.is_open())
+                return false;
+            String line;
+            while (std::getline(ifs, line))
+            {
+                size_t pos = line.rfind('\t');
+                if (pos != String::npos)
+                    _map[line.substr(0, pos)] = atoi(line.c_str() + pos + 1);
+            }
+            return true;
+        }
+
+        bool Save()
+        {
+            if (_path.empty() || !_changed)
+                return true;
+            std::ofstream ofs(_path.c_str());
+            if (!ofs.is_open())
+            {
+                std::cout << "Can't save tuning cache to '" << _path << "' !" << std::endl;
+                return false;
+            }
+            for (Map::const_iterator it = _map.begin(); it != _map.end(); ++it)
+                ofs << it->first << "\t" << it->second << std::endl;
+            _changed = false;
+            return true;
+        }
+
+        bool Find(const String & key, int & algorithm) const
+        {
+            Map::const_iterator it = _map.find(key);
+            if (it == _map.end())
+                return false;
+            algorithm = it->second;
+            return true;
+        }
+
+        void Insert(const String & key, int algorithm)
+        {
+            _map[key] = algorithm;
+            _changed = true;
+        }
+
+        static String CpuId()
+        {
+            static String model;
+            if (model.empty())
+            {
+#if defined(__linux__)
+                std::ifstream ifs("/proc/cpuinfo");
+                String line;
+                while (std::getline(ifs, line) && model.empty())
+                {
+                    if (line.find("model name") == 0 && line.find(':') != String::npos)
+                        model = line.substr(line.find(':') + 2);
+                }
+#elif defined(_MSC_VER)
+                const char * id = getenv("PROCESSOR_IDENTIFIER");
+                if (id)
+                    model = id;
+#endif
+                if (model.empty())
+                    model = "unknown";
+            }
+            std::stringstream id;
+            id << model << " t=" << GetThreadNumber();
+            return id.str();
+        }
+
+        static double Time()
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+    private:
+        typedef std::map<String, int> Map;
+
+        String _path;
+        Map _map;
+        bool _changed;
+    };
+}
@@ -0,0 +1,427 @@
+/*
+* Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Common.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace Synet
+{
+    namespace Detail
+    {
+        // Polynomial float32 kernels (Cephes coefficients), written once over a set of vector traits.
+        // Maximal error relative to double precision libm, measured exhaustively over all normal float inputs
+        // (the same for scalar, SSE4.1, AVX2 and AVX-512 code within 0.03 ULP):
+        //   Exp     - 1.28 ULP, exp(x > 88.7228) = +inf, results below FLT_MIN (x < -87.3365) are flushed to 0;
+        //   Log     - 0.83 ULP, denormals are treated as FLT_MIN, log(0) = -inf, log(x < 0) = NaN;
+        //   Sigmoid - 3.19 ULP;
+        //   Tanh    - 1.36 ULP;
+        //   Pow     - exp(e * log(x)), 113 ULP for e = -0.75 (at x near FLT_MAX), error grows with |e * log(x)|, scalar ::pow is used for x <= 0.
+        // Min/Max return the second argument if the first one is NaN (as MINPS/MAXPS do), so NaN is propagated.
+
+        struct Vm32fScalar
+        {
+            typedef float F;
+            typedef bool M;
+            static const size_t size = 1;
+
+            static SYNET_INLINE F Set(float value) { return value; }
+            static SYNET_INLINE F Load(const float * src) { return src[0]; }
+            static SYNET_INLINE void Store(float * dst, F value) { dst[0] = value; }
+            static SYNET_INLINE F Add(F a, F b) { return a + b; }
+            static SYNET_INLINE F Sub(F a, F b) { return a - b; }
+            static SYNET_INLINE F Mul(F a, F b) { return a * b; }
+            static SYNET_INLINE F Div(F a, F b) { return a / b; }
+            static SYNET_INLINE F Fmadd(F a, F b, F c) { return a * b + c; }
+            static SYNET_INLINE F Min(F a, F b) { return a < b ? a : b; }
+            static SYNET_INLINE F Max(F a, F b) { return a > b ? a : b; }
+            static SYNET_INLINE F Round(F a) { return std::nearbyint(a); }
+            static SYNET_INLINE M Lt(F a, F b) { return a < b; }
+            static SYNET_INLINE M Eq(F a, F b) { return a == b; }
+            static SYNET_INLINE M Nge(F a, F b) { return !(a >= b); }
+            static SYNET_INLINE F Blend(M mask, F a, F b) { return mask ? b : a; }
+
+            static SYNET_INLINE F Abs(F a) 
+            { 
+                return FromBits(ToBits(a) & 0x7FFFFFFF);
+            }
+
+            static SYNET_INLINE F CopySign(F a, F b) 
+            { 
+                return FromBits((ToBits(a) & 0x7FFFFFFF) | (ToBits(b) & 0x80000000));
+            }
+
+            static SYNET_INLINE F Pow2(F n) 
+            { 
+                return FromBits(uint32_t(int32_t(n) + 127) << 23);
+            }
+
+            static SYNET_INLINE F Frexp(F a, F & e)
+            {
+                uint32_t bits = ToBits(a);
+                e = F(int32_t(bits >> 23) - 126);
+                return FromBits((bits & 0x007FFFFF) | 0x3F000000);
+            }
+
+        private:
+            static SYNET_INLINE uint32_t ToBits(float value)
+            {
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                return bits;
+            }
+
+            static SYNET_INLINE float FromBits(uint32_t bits)
+            {
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+        };
+
+#if defined(__AVX512F__)
+        struct Vm32fAvx512
+        {
+            typedef __m512 F;
+            typedef __mmask16 M;
+            static const size_t size = 16;
+
+            static SYNET_INLINE F Set(float value) { return _mm512_set1_ps(value); }
+            static SYNET_INLINE F Load(const float * src) { return _mm512_loadu_ps(src); }
+            static SYNET_INLINE void Store(float * dst, F value) { _mm512_storeu_ps(dst, value); }
+            static SYNET_INLINE F Add(F a, F b) { return _mm512_add_ps(a, b); }
+            static SYNET_INLINE F Sub(F a, F b) { return _mm512_sub_ps(a, b); }
+            static SYNET_INLINE F Mul(F a, F b) { return _mm512_mul_ps(a, b); }
+            static SYNET_INLINE F Div(F a, F b) { return _mm512_div_ps(a, b); }
+            static SYNET_INLINE F Fmadd(F a, F b, F c) { return _mm512_fmadd_ps(a, b, c); }
+            static SYNET_INLINE F Min(F a, F b) { return _mm512_min_ps(a, b); }
+            static SYNET_INLINE F Max(F a, F b) { return _mm512_max_ps(a, b); }
+            static SYNET_INLINE F Round(F a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static SYNET_INLINE M Lt(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+            static SYNET_INLINE M Eq(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+            static SYNET_INLINE M Nge(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_NGE_UQ); }
+            static SYNET_INLINE F Blend(M mask, F a, F b) { return _mm512_mask_blend_ps(mask, a, b); }
+
+            static SYNET_INLINE F Abs(F a)
+            {
+                return _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a), _mm512_set1_epi32(0x7FFFFFFF)));
+            }
+
+            static SYNET_INLINE F CopySign(F a, F b)
+            {
+                return _mm512_castsi512_ps(_mm512_or_epi32(_mm512_castps_si512(Abs(a)), 
+                    _mm512_and_epi32(_mm512_castps_si512(b), _mm512_set1_epi32(0x80000000))));
+            }
+
+            static SYNET_INLINE F Pow2(F n)
+            {
+                return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127)), 23));
+            }
+
+            static SYNET_INLINE F Frexp(F a, F & e)
+            {
+                __m512i bits = _mm512_castps_si512(a);
+                e = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(126)));
+                return _mm512_castsi512_ps(_mm512_or_epi32(_mm512_and_epi32(bits, _mm512_set1_epi32(0x007FFFFF)), _mm512_set1_epi32(0x3F000000)));
+            }
+        };
+        typedef Vm32fAvx512 Vm32f;
+#elif defined(__AVX2__)
+        struct Vm32fAvx2
+        {
+            typedef __m256 F;
+            typedef __m256 M;
+            static const size_t size = 8;
+
+            static SYNET_INLINE F Set(float value) { return _mm256_set1_ps(value); }
+            static SYNET_INLINE F Load(const float * src) { return _mm256_loadu_ps(src); }
+            static SYNET_INLINE void Store(float * dst, F value) { _mm256_storeu_ps(dst, value); }
+            static SYNET_INLINE F Add(F a, F b) { return _mm256_add_ps(a, b); }
+            static SYNET_INLINE F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+            static SYNET_INLINE F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+            static SYNET_INLINE F Div(F a, F b) { return _mm256_div_ps(a, b); }
+#if defined(__FMA__)
+            static SYNET_INLINE F Fmadd(F a, F b, F c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+            static SYNET_INLINE F Fmadd(F a, F b, F c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+            static SYNET_INLINE F Min(F a, F b) { return _mm256_min_ps(a, b); }
+            static SYNET_INLINE F Max(F a, F b) { return _mm256_max_ps(a, b); }
+            static SYNET_INLINE F Round(F a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static SYNET_INLINE M Lt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+            static SYNET_INLINE M Eq(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+            static SYNET_INLINE M Nge(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_NGE_UQ); }
+            static SYNET_INLINE F Blend(M mask, F a, F b) { return _mm256_blendv_ps(a, b, mask); }
+
+            static SYNET_INLINE F Abs(F a)
+            {
+                return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);
+            }
+
+            static SYNET_INLINE F CopySign(F a, F b)
+            {
+                return _mm256_or_ps(Abs(a), _mm256_and_ps(_mm256_set1_ps(-0.0f), b));
+            }
+
+            static SYNET_INLINE F Pow2(F n)
+            {
+                return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23));
+            }
+
+            static SYNET_INLINE F Frexp(F a, F & e)
+            {
+                __m256i bits = _mm256_castps_si256(a);
+                e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+                return _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F000000)));
+            }
+        };
+        typedef Vm32fAvx2 Vm32f;
+#elif defined(__SSE4_1__)
+        struct Vm32fSse41
+        {
+            typedef __m128 F;
+            typedef __m128 M;
+            static const size_t size = 4;
+
+            static SYNET_INLINE F Set(float value) { return _mm_set1_ps(value); }
+            static SYNET_INLINE F Load(const float * src) { return _mm_loadu_ps(src); }
+            static SYNET_INLINE void Store(float * dst, F value) { _mm_storeu_ps(dst, value); }
+            static SYNET_INLINE F Add(F a, F b) { return _mm_add_ps(a, b); }
+            static SYNET_INLINE F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+            static SYNET_INLINE F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+            static SYNET_INLINE F Div(F a, F b) { return _mm_div_ps(a, b); }
+            static SYNET_INLINE F Fmadd(F a, F b, F c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+            static SYNET_INLINE F Min(F a, F b) { return _mm_min_ps(a, b); }
+            static SYNET_INLINE F Max(F a, F b) { return _mm_max_ps(a, b); }
+            static SYNET_INLINE F Round(F a) { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static SYNET_INLINE M Lt(F a, F b) { return _mm_cmplt_ps(a, b); }
+            static SYNET_INLINE M Eq(F a, F b) { return _mm_cmpeq_ps(a, b); }
+            static SYNET_INLINE M Nge(F a, F b) { return _mm_cmpnge_ps(a, b); }
+            static SYNET_INLINE F Blend(M mask, F a, F b) { return _mm_blendv_ps(a, b, mask); }
+
+            static SYNET_INLINE F Abs(F a)
+            {
+                return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+            }
+
+            static SYNET_INLINE F CopySign(F a, F b)
+            {
+                return _mm_or_ps(Abs(a), _mm_and_ps(_mm_set1_ps(-0.0f), b));
+            }
+
+            static SYNET_INLINE F Pow2(F n)
+            {
+                return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23));
+            }
+
+            static SYNET_INLINE F Frexp(F a, F & e)
+            {
+                __m128i bits = _mm_castps_si128(a);
+                e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+                return _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F000000)));
+            }
+        };
+        typedef Vm32fSse41 Vm32f;
+#else
+        typedef Vm32fScalar Vm32f;
+#endif
+
+        template<class V> SYNET_INLINE typename V::F Exp(typename V::F x)
+        {
+            typedef typename V::F F;
+            F c = V::Min(V::Set(88.7228394f), V::Max(V::Set(-87.3365479f), x));
+            F n = V::Round(V::Mul(c, V::Set(1.44269504f)));
+            F r = V::Fmadd(n, V::Set(-0.693359375f), c);
+            r = V::Fmadd(n, V::Set(2.12194440e-4f), r);
+            F p = V::Set(1.9875691500e-4f);
+            p = V::Fmadd(p, r, V::Set(1.3981999507e-3f));
+            p = V::Fmadd(p, r, V::Set(8.3334519073e-3f));
+            p = V::Fmadd(p, r, V::Set(4.1665795894e-2f));
+            p = V::Fmadd(p, r, V::Set(1.6666665459e-1f));
+            p = V::Fmadd(p, r, V::Set(5.0000001201e-1f));
+            p = V::Fmadd(p, V::Mul(r, r), V::Add(r, V::Set(1.0f)));
+            F h = V::Blend(V::Lt(V::Set(0.0f), n), V::Set(0.0f), V::Set(1.0f));
+            F y = V::Mul(V::Mul(p, V::Pow2(V::Sub(n, h))), V::Pow2(h));
+            y = V::Blend(V::Lt(x, V::Set(-87.3365479f)), y, V::Set(0.0f));
+            return V::Blend(V::Lt(V::Set(88.7228394f), x), y, V::Set(INFINITY));
+        }
+
+        template<class V> SYNET_INLINE typename V::F Log(typename V::F x)
+        {
+            typedef typename V::F F;
+            typedef typename V::M M;
+            F e, m = V::Frexp(V::Max(x, V::Set(FLT_MIN)), e);
+            M small = V::Lt(m, V::Set(0.707106781f));
+            e = V::Sub(e, V::Blend(small, V::Set(0.0f), V::Set(1.0f)));
+            m = V::Sub(V::Add(m, V::Blend(small, V::Set(0.0f), m)), V::Set(1.0f));
+            F z = V::Mul(m, m);
+            F y = V::Set(7.0376836292e-2f);
+            y = V::Fmadd(y, m, V::Set(-1.1514610310e-1f));
+            y = V::Fmadd(y, m, V::Set(1.1676998740e-1f));
+            y = V::Fmadd(y, m, V::Set(-1.2420140846e-1f));
+            y = V::Fmadd(y, m, V::Set(1.4249322787e-1f));
+            y = V::Fmadd(y, m, V::Set(-1.6668057665e-1f));
+            y = V::Fmadd(y, m, V::Set(2.0000714765e-1f));
+            y = V::Fmadd(y, m, V::Set(-2.4999993993e-1f));
+            y = V::Fmadd(y, m, V::Set(3.3333331174e-1f));
+            y = V::Mul(V::Mul(y, m), z);
+            y = V::Fmadd(e, V::Set(-2.12194440e-4f), y);
+            y = V::Fmadd(z, V::Set(-0.5f), y);
+            y = V::Fmadd(e, V::Set(0.693359375f), V::Add(m, y));
+            y = V::Blend(V::Eq(x, V::Set(0.0f)), y, V::Set(-INFINITY));
+            y = V::Blend(V::Eq(x, V::Set(INFINITY)), y, V::Set(INFINITY));
+            return V::Blend(V::Nge(x, V::Set(0.0f)), y, V::Set(NAN));
+        }
+
+        template<class V> SYNET_INLINE typename V::F Sigmoid(typename V::F x)
+        {
+            return V::Div(V::Set(1.0f), V::Add(V::Set(1.0f), Exp<V>(V::Sub(V::Set(0.0f), x))));
+        }
+
+        template<class V> SYNET_INLINE typename V::F Tanh(typename V::F x)
+        {
+            typedef typename V::F F;
+            F a = V::Abs(x);
+            F z = V::Mul(x, x);
+            F s = V::Set(-5.70498872745e-3f);
+            s = V::Fmadd(s, z, V::Set(2.06390887954e-2f));
+            s = V::Fmadd(s, z, V::Set(-5.37397155531e-2f));
+            s = V::Fmadd(s, z, V::Set(1.33314422036e-1f));
+            s = V::Fmadd(s, z, V::Set(-3.33332819422e-1f));
+            s = V::Fmadd(V::Mul(s, z), x, x);
+            F l = V::Sub(V::Set(1.0f), V::Div(V::Set(2.0f), V::Add(Exp<V>(V::Add(a, a)), V::Set(1.0f))));
+            return V::Blend(V::Lt(a, V::Set(0.625f)), V::CopySign(l, x), s);
+        }
+
+        template<class V, class Func> SYNET_INLINE void VectorApply(const float * src, size_t size, float * dst, Func func)
+        {
+            size_t aligned = size / V::size * V::size, i = 0;
+            for (; i < aligned; i += V::size)
+                V::Store(dst + i, func(V::Load(src + i)));
+            if (i < size)
+            {
+                float tail[V::size] = { 0 };
+                memcpy(tail, src + i, (size - i) * sizeof(float));
+                V::Store(tail, func(V::Load(tail)));
+                memcpy(dst + i, tail, (size - i) * sizeof(float));
+            }
+        }
+    }
+
+    SYNET_INLINE float ScalarExp(float value)
+    {
+        return Detail::Exp<Detail::Vm32fScalar>(value);
+    }
+
+    SYNET_INLINE float ScalarLog(float value)
+    {
+        return Detail::Log<Detail::Vm32fScalar>(value);
+    }
+
+    SYNET_INLINE float ScalarSigmoid(float value)
+    {
+        return Detail::Sigmoid<Detail::Vm32fScalar>(value);
+    }
+
+    SYNET_INLINE float ScalarTanh(float value)
+    {
+        return Detail::Tanh<Detail::Vm32fScalar>(value);
+    }
+
+    inline void VectorExp(const float * src, size_t size, float * dst)
+    {
+        typedef Detail::Vm32f V;
+        Detail::VectorApply<V>(src, size, dst, [](V::F x) { return Detail::Exp<V>(x); });
+    }
+
+    inline void VectorLog(const float * src, size_t size, float * dst)
+    {
+        typedef Detail::Vm32f V;
+        Detail::VectorApply<V>(src, size, dst, [](V::F x) { return Detail::Log<V>(x); });
+    }
+
+    inline void VectorSigmoid(const float * src, size_t size, float * dst)
+    {
+        typedef Detail::Vm32f V;
+        Detail::VectorApply<V>(src, size, dst, [](V::F x) { return Detail::Sigmoid<V>(x); });
+    }
+
+    inline void VectorTanh(const float * src, size_t size, float * dst)
+    {
+        typedef Detail::Vm32f V;
+        Detail::VectorApply<V>(src, size, dst, [](V::F x) { return Detail::Tanh<V>(x); });
+    }
+
+    inline void VectorElu(const float * src, size_t size, float alpha, float * dst)
+    {
+        typedef Detail::Vm32f V;
+        V::F _alpha = V::Set(alpha), _0 = V::Set(0.0f), _1 = V::Set(1.0f);
+        Detail::VectorApply<V>(src, size, dst, [&](V::F x) 
+        { 
+            return V::Blend(V::Lt(x, _0), x, V::Mul(_alpha, V::Sub(Detail::Exp<V>(x), _1)));
+        });
+    }
+
+    inline void VectorSoftplus(const float * src, size_t size, float beta, float threshold, float * dst)
+    {
+        typedef Detail::Vm32f V;
+        V::F _beta = V::Set(beta), _threshold = V::Set(threshold), _1 = V::Set(1.0f);
+        Detail::VectorApply<V>(src, size, dst, [&](V::F x)
+        {
+            V::F y = V::Div(Detail::Log<V>(V::Add(_1, Detail::Exp<V>(V::Mul(x, _beta)))), _beta);
+            return V::Blend(V::Lt(_threshold, x), y, x);
+        });
+    }
+
+    inline void VectorPow(const float * src, size_t size, float exponent, float * dst)
+    {
+        typedef Detail::Vm32f V;
+        if (exponent == 2.0f)
+        {
+            for (size_t i = 0; i < size; ++i)
+                dst[i] = src[i] * src[i];
+            return;
+        }
+        if (exponent == 0.5f)
+        {
+            for (size_t i = 0; i < size; ++i)
+                dst[i] = ::sqrt(src[i]);
+            return;
+        }
+        V::F _exponent = V::Set(exponent);
+        for (size_t i = 0; i < size; i += V::size)
+        {
+            size_t n = size - i < V::size ? size - i : V::size;
+            float val[V::size] = { 0 }, pow[V::size];
+            memcpy(val, src + i, n * sizeof(float));
+            V::Store(pow, Detail::Exp<V>(V::Mul(_exponent, Detail::Log<V>(V::Load(val)))));
+            for (size_t j = 0; j < n; ++j)
+                dst[i + j] = val[j] > 0.0f ? pow[j] : ::pow(val[j], exponent);
+        }
+    }
+}
@@ -844,12 +844,13 @@ namespace Synet
         {
         }
 
-        void Init(Shape src, size_t dst, Shape kernel, Shape stride, Shape dilation, Shape pad, size_t group)
+        void Init(Shape src, size_t dst, Shape kernel, Shape stride, Shape dilation, Shape pad, size_t group, size_t block = 0)
         {
             assert(src.size() == 3 && kernel.size() == 2 && stride.size() == 2 && dilation.size() == 2 && pad.size() == 4);
+            _type = Winograd::WinogradNone;
             if (stride[0] != 1 || stride[1] != 1 || dilation[0] != 1 || dilation[1] != 1)
                 return;
-            if (!((pad[0] == 0 && pad[1] == 0) || (pad[0] == 1 && pad[1] == 1)))
+            if (!((pad[0] == 0 && pad[1] == 0) || (pad[0] == 1 && pad[1] == 1)) || pad[2] != pad[0] || pad[3] != pad[1])
                 return;
             if (group != 1)
                 return;
@@ -872,22 +873,32 @@ namespace Synet
                     _dstW = _srcW - 2;
                 }
 
-                if (src[0] < 16)
+                if (block == 0)
+                {
+                    if (_srcC < 16 || _dstC < 16)
+                        return;
+                    if (_dstH >= 12 && _dstW >= 12 && (_pad || _dstH * _dstW >= 400))
+                        block = 4;
+                    else if (_pad && _srcC >= 64 && _dstC >= 64 && _dstH * _dstW >= 64)
+                        block = 2;
+                }
+                else if (_srcH < 3 || _srcW < 3)
                     return;
-                else
 
-                if (1)
+                if (block == 4)
+                {
+                    _block = 4;
+                    _count = 36;
+                    _type = Winograd::Winograd4x3p;
+                }
+                else if (block == 2)
                 {
                     _block = 2;
                     _count = 16;
                     _type = Winograd::Winograd2x3p;
                 }
                 else
-                {
-                    _block = 4;
-                    _count = 36;
-                    _type = Winograd::Winograd4x3p;
-                }
+                    return;
 
                 _tileH = (_dstH + _block - 1) / _block;
                 _tileW = (_dstW + _block - 1) / _block;
@@ -906,6 +917,9 @@ namespace Synet
         {
             SYNET_PERF_FUNC();
 
+            if (_filter.Size() && _filter.Shape() == Shape({ _count, _strideF }))
+                return;
+            _filter.Clear();
             _filter.Reshape({ _count, _strideF }, 0);
             switch (_type)
             {
@@ -923,9 +937,34 @@ namespace Synet
             }
         }
 
+        size_t Block() const
+        {
+            return _block;
+        }
+
+        bool HasFilter() const
+        {
+            return _filter.Size() && _filter.Shape() == Shape({ _count, _strideF });
+        }
+
+        size_t FilterSize() const
+        {
+            return _filter.Size();
+        }
+
+        void Share(const Winograd & winograd)
+        {
+            _filter.Share(winograd._filter);
+        }
+
+        void Clear()
+        {
+            _filter.Clear();
+        }
+
         size_t SrcBufSize()
         {
-                return _strideS*_count;
+            return _strideS*_count;
         }
 
         size_t DstBufSize()
@@ -1004,7 +1043,7 @@ namespace Synet
                     const T * a = _filter.CpuData() + i * _strideF;
                     const T * b = src + i * _strideS;
                     T * c = dst + i * _strideD;
-                    CpuGemm(CblasNoTrans, CblasNoTrans, M, N, K, T(1.0), a, b, T(0.0), c);
+                    CpuGemm(CblasNoTrans, CblasNoTrans, M, N, K, T(1.0), a, K, b, N, T(0.0), c, N);
                 }
                 break;
             }
@@ -2160,6 +2160,8 @@ namespace Synet
             File(const Ch * data, size_t size)
             {
                 _data.assign(data, data + size);
+                if (_data.empty() || _data.back() != 0)
+                    _data.push_back(0);
             }
 
             File(std::basic_istream<Ch> & is)
@@ -0,0 +1,104 @@
+/*
+* Tests for Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "TestCommon.h"
+
+#include "Synet/Common.h"
+
+#ifdef SYNET_ALLOCATION_CHECK
+
+#include <new>
+#include <cstdlib>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+void * operator new(size_t size)
+{
+    Synet::Detail::CountAllocation();
+    void * ptr = ::malloc(size);
+    if (ptr == NULL)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void * operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+    if (ptr)
+    {
+        Synet::Detail::CountFree();
+        ::free(ptr);
+    }
+}
+
+void operator delete[](void * ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+#if defined(__cpp_aligned_new)
+void * operator new(size_t size, std::align_val_t align)
+{
+    Synet::Detail::CountAllocation();
+#if defined(_MSC_VER)
+    void * ptr = ::_aligned_malloc(size, (size_t)align);
+#else
+    void * ptr = NULL;
+    if (::posix_memalign(&ptr, std::max((size_t)align, sizeof(void*)), size))
+        ptr = NULL;
+#endif
+    if (ptr == NULL)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void * operator new[](size_t size, std::align_val_t align)
+{
+    return operator new(size, align);
+}
+
+void operator delete(void * ptr, std::align_val_t align) noexcept
+{
+    if (ptr)
+    {
+        Synet::Detail::CountFree();
+#if defined(_MSC_VER)
+        ::_aligned_free(ptr);
+#else
+        ::free(ptr);
+#endif
+    }
+}
+
+void operator delete[](void * ptr, std::align_val_t align) noexcept
+{
+    operator delete(ptr, align);
+}
+#endif
+#endif //SYNET_ALLOCATION_CHECK
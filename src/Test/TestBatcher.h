@@ -0,0 +1,145 @@
+/*
+* Tests for Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "TestOptimizer.h"
+
+#include "Synet/Batcher.h"
+
+#include <atomic>
+
+namespace Test
+{
+    typedef Synet::Batcher<float> UnitBatcher;
+
+    struct UnitRegionSettings
+    {
+        float threshold, overlap;
+        size_t topK;
+    };
+
+    inline bool UnitSameRegions(const UnitNet::Regions & a, const UnitNet::Regions & b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            const float va[5] = { a[i].x, a[i].y, a[i].w, a[i].h, a[i].prob }, vb[5] = { b[i].x, b[i].y, b[i].w, b[i].h, b[i].prob };
+            for (size_t j = 0; j < 5; ++j)
+                if (!(::fabs(va[j] - vb[j]) <= 0.0001f * std::max(1.0f, ::fabs(vb[j]))))
+                    return false;
+            if (a[i].id != b[i].id)
+                return false;
+        }
+        return true;
+    }
+
+    inline bool TestBatcher()
+    {
+        Synet::NetworkParam network;
+        Synet::Floats bin;
+        network.layers().push_back(UnitInput("data", Synet::Shape({ 1, 16, 6, 5 })));
+        network.layers().push_back(UnitConvolution("conv", "data", 16, 16, 1, 1, false, Synet::ActivationFunctionTypeIdentity, bin));
+        network.layers().push_back(UnitYolo("yolo", "conv"));
+        UnitNet net;
+        if (!UnitLoad(network, bin, net))
+            return false;
+
+        const size_t inputs = 5, threads = 4, requests = 8;
+        const UnitRegionSettings settings[2] = { { 0.3f, 0.5f, 0 }, { 0.5f, 0.3f, 2 } };
+        std::vector<Synet::Floats> src(inputs), dst(inputs);
+        std::vector<UnitNet::Regions> regions[2];
+        for (size_t i = 0; i < inputs; ++i)
+        {
+            dst[i] = UnitForward(net, 0.1f * float(i));
+            src[i].assign(net.Src()[0]->CpuData(), net.Src()[0]->CpuData() + net.Src()[0]->Size());
+            for (size_t s = 0; s < 2; ++s)
+                regions[s].push_back(net.GetRegions(320 + 10 * i, 240, settings[s].threshold, settings[s].overlap, settings[s].topK));
+        }
+        if (regions[0][0].empty() || UnitSameRegions(regions[0][0], regions[1][0]))
+        {
+            std::cout << "Batcher: test regions settings are indistinguishable !" << std::endl;
+            return false;
+        }
+
+        UnitBatcher batcher;
+        if (!batcher.Init(net, Synet::Shape({ 1, 2, 4 }), 0.002) || batcher.MaxBatch() != 4)
+            return false;
+        batcher.SetRegions(settings[0].threshold, settings[0].overlap, settings[0].topK);
+        std::atomic<bool> done(false);
+        std::atomic<size_t> errors(0);
+        std::thread setter([&]()
+        {
+            for (size_t i = 0; !done; ++i)
+            {
+                const UnitRegionSettings & s = settings[i % 2];
+                batcher.SetRegions(s.threshold, s.overlap, s.topK);
+                std::this_thread::yield();
+            }
+        });
+        std::vector<std::thread> submitters;
+        for (size_t t = 0; t < threads; ++t)
+        {
+            submitters.push_back(std::thread([&, t]()
+            {
+                std::vector<std::future<UnitBatcher::Result>> results(requests);
+                for (size_t r = 0; r < requests; ++r)
+                    if (!batcher.Push(src[(t + r) % inputs], results[r], 320 + 10 * ((t + r) % inputs), 240))
+                        errors++;
+                for (size_t r = 0; r < requests && errors == 0; ++r)
+                {
+                    size_t i = (t + r) % inputs;
+                    UnitBatcher::Result result = results[r].get();
+                    Synet::Floats out(result.dst[0].CpuData(), result.dst[0].CpuData() + result.dst[0].Size());
+                    if (result.dst.size() != 1 || !UnitCompare(out, dst[i], 0.0001f, "Batcher output"))
+                        errors++;
+                    else if (!UnitSameRegions(result.regions, regions[0][i]) && !UnitSameRegions(result.regions, regions[1][i]))
+                    {
+                        std::cout << "Batcher: regions of request " << r << " from thread " << t << " match none of the settings !" << std::endl;
+                        errors++;
+                    }
+                }
+            }));
+        }
+        for (size_t t = 0; t < threads; ++t)
+            submitters[t].join();
+        done = true;
+        setter.join();
+        if (errors)
+            return false;
+
+        batcher.SetRegions(settings[1].threshold, settings[1].overlap, settings[1].topK);
+        UnitBatcher::Result result;
+        if (!batcher.Forward(src[0], result, 320, 240))
+            return false;
+        if (!UnitSameRegions(result.regions, regions[1][0]))
+        {
+            std::cout << "Batcher: regions don't follow the last SetRegions() !" << std::endl;
+            return false;
+        }
+        batcher.Stop();
+        return !batcher.Forward(src[0], result);
+    }
+}
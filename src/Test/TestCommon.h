@@ -35,6 +35,7 @@
 #define SYNET_SYNET_RUN
 //#define SYNET_LAYER_STATISTIC
 //#define SYNET_SIZE_STATISTIC
+//#define SYNET_ALLOCATION_CHECK
 
 //#define SYNET_TEST_MEMORY_LOAD
 //#define SYNET_TEST_NET_RESHAPE
@@ -161,6 +161,19 @@ namespace Test
 #ifdef SYNET_SYNET_RUN
                 if ((_options.enable & ENABLE_SYNET) && !InitNetwork(_options.synetModel, _options.synetWeight, _synets[0]))
                     return false;
+                if (_options.enable & ENABLE_SYNET)
+                {
+                    for (size_t t = 1; t < _synets.size(); ++t)
+                    {
+                        if (!_synets[t].Init(_synets[0], _options, _param()))
+                        {
+                            std::cout << "Can't share " << _synets[0].Name() << " weights for thread " << t << " !" << std::endl;
+                            return false;
+                        }
+                    }
+                    for (size_t t = 0; t < _synets.size(); ++t)
+                        _synets[t].CompactWeight();
+                }
 #endif            
 #if defined(SYNET_OTHER_RUN) && defined(SYNET_SYNET_RUN)
             if (_options.enable == (ENABLE_OTHER | ENABLE_SYNET))
@@ -515,10 +528,6 @@ namespace Test
                 if ((options.enable & ENABLE_OTHER) && !comparer->InitNetwork(options.otherModel, options.otherWeight, comparer->_others[thread]))
                     ::exit(0);
 #endif
-#ifdef SYNET_SYNET_RUN
-                if ((options.enable & ENABLE_SYNET) && !comparer->InitNetwork(options.synetModel, options.synetWeight, comparer->_synets[thread]))
-                    ::exit(0);
-#endif 
             }
 #if defined(SYNET_OTHER_RUN) && defined(SYNET_SYNET_RUN)
             if(options.enable == (ENABLE_OTHER | ENABLE_SYNET))
@@ -23,6 +23,7 @@
 */
 
 #include "TestCompare.h"
+#include "TestGemm.h"
 
 #ifdef SYNET_OTHER_RUN
 
@@ -238,6 +239,8 @@ int main(int argc, char* argv[])
         Test::Comparer<Test::DarknetNetwork> comparer(options);
         options.result = comparer.Run();
     }
+    else if (options.mode == "gemm")
+        options.result = Test::BenchmarkGemm(options.workThreads);
     else
         std::cout << "Unknown mode : " << options.mode << std::endl;
 
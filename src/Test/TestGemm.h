@@ -0,0 +1,201 @@
+/*
+* Tests for Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Utils/Gemm.h"
+
+#include <chrono>
+
+namespace Test
+{
+    struct GemmSize
+    {
+        size_t M, N, K;
+    };
+
+    template<class Func> inline double GemmSeconds(Func func, double time)
+    {
+        typedef std::chrono::steady_clock Clock;
+        func();
+        size_t count = 0;
+        Clock::time_point start = Clock::now(), current = start;
+        do
+        {
+            func();
+            count++;
+            current = Clock::now();
+        } while (std::chrono::duration<double>(current - start).count() < time);
+        return std::chrono::duration<double>(current - start).count() / count;
+    }
+
+    inline bool BenchmarkGemm(size_t threads, double time = 0.5)
+    {
+        const GemmSize sizes[] = { { 32, 12544, 27 }, { 64, 3136, 576 }, { 128, 784, 1152 }, { 256, 196, 2304 }, { 512, 49, 4608 }, { 1024, 1024, 1024 } };
+        Synet::SetThreadNumber(threads);
+        std::cout << "GEMM benchmark (" << threads << " thread(s)): old - reference loops, new - packed engine." << std::endl;
+        std::cout << std::setw(6) << "M" << std::setw(7) << "N" << std::setw(6) << "K";
+        std::cout << std::setw(12) << "old GFLOPS" << std::setw(12) << "new GFLOPS" << std::setw(10) << "speedup" << std::setw(12) << "max diff" << std::endl;
+        bool result = true;
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+        {
+            size_t M = sizes[s].M, N = sizes[s].N, K = sizes[s].K;
+            std::vector<float> A(M * K), B(K * N), C0(M * N), C1(M * N);
+            for (size_t i = 0; i < A.size(); ++i)
+                A[i] = float(i * 7 % 31) / 31.0f - 0.5f;
+            for (size_t i = 0; i < B.size(); ++i)
+                B[i] = float(i * 13 % 29) / 29.0f - 0.5f;
+            double oldTime = GemmSeconds([&]()
+            {
+                std::fill(C0.begin(), C0.end(), 0.0f);
+                Synet::Detail::CpuGemmNN(M, N, K, 1.0f, A.data(), K, B.data(), N, C0.data(), N);
+            }, time);
+            double newTime = GemmSeconds([&]()
+            {
+                Synet::Detail::GemmEngine(false, false, M, N, K, 1.0f, A.data(), K, (const float*)NULL, B.data(), N, (const float*)NULL, 0.0f, C1.data(), N, Synet::Detail::GemmNoPost());
+            }, time);
+            float diff = 0;
+            for (size_t i = 0; i < C0.size(); ++i)
+                diff = std::max(diff, ::fabs(C0[i] - C1[i]) / std::max(1.0f, ::fabs(C0[i])));
+            double flop = 2.0 * M * N * K * 1.0e-9;
+            std::cout << std::setw(6) << M << std::setw(7) << N << std::setw(6) << K << std::fixed << std::setprecision(2);
+            std::cout << std::setw(12) << flop / oldTime << std::setw(12) << flop / newTime << std::setw(10) << oldTime / newTime;
+            std::cout << std::setw(12) << std::scientific << std::setprecision(1) << diff << std::defaultfloat << std::endl;
+            if (diff > 1.0e-4f)
+                result = false;
+        }
+        return result;
+    }
+
+    inline float GemmRandom(size_t i, size_t seed)
+    {
+        return float((i * 2654435761u + seed * 40503u) % 1000) / 500.0f - 1.0f;
+    }
+
+    inline bool TestGemm32f(bool transA, bool transB, size_t M, size_t N, size_t K, float beta, bool packed)
+    {
+        size_t lda = (transA ? M : K) + 3, ldb = (transB ? K : N) + 5, ldc = N + 7;
+        std::vector<float> A((transA ? K : M) * lda), B((transB ? N : K) * ldb), C(M * ldc), R(M * ldc);
+        for (size_t i = 0; i < A.size(); ++i)
+            A[i] = GemmRandom(i, 1);
+        for (size_t i = 0; i < B.size(); ++i)
+            B[i] = GemmRandom(i, 2);
+        for (size_t i = 0; i < C.size(); ++i)
+            C[i] = beta == 0.0f ? NAN : GemmRandom(i, 3);
+        for (size_t i = 0; i < M; ++i)
+            for (size_t j = 0; j < N; ++j)
+            {
+                double sum = 0;
+                for (size_t k = 0; k < K; ++k)
+                    sum += double(transA ? A[k * lda + i] : A[i * lda + k]) * double(transB ? B[j * ldb + k] : B[k * ldb + j]);
+                R[i * ldc + j] = float(sum * 0.5 + (beta == 0.0f ? 0.0 : beta * C[i * ldc + j])) + (packed ? 1.0f : 0.0f);
+            }
+        Synet::CblasTranspose tA = transA ? Synet::CblasTrans : Synet::CblasNoTrans, tB = transB ? Synet::CblasTrans : Synet::CblasNoTrans;
+        if (packed)
+        {
+            std::vector<float> pA(Synet::CpuGemmPackedSizeA<float>(M, K)), pB(Synet::CpuGemmPackedSizeB<float>(N, K));
+            Synet::CpuGemmPackA(tA, M, K, A.data(), lda, pA.data());
+            Synet::CpuGemmPackB(tB, N, K, B.data(), ldb, pB.data());
+            Synet::CpuGemmPacked(tA, tB, M, N, K, 0.5f, A.data(), lda, pA.data(), B.data(), ldb, pB.data(), beta, C.data(), ldc, [](size_t rows, size_t cols, float * c, size_t ldc)
+            {
+                for (size_t i = 0; i < rows; ++i)
+                    for (size_t j = 0; j < cols; ++j)
+                        c[i * ldc + j] += 1.0f;
+            });
+        }
+        else
+            Synet::CpuGemm(tA, tB, M, N, K, 0.5f, A.data(), lda, B.data(), ldb, beta, C.data(), ldc);
+        for (size_t i = 0; i < M; ++i)
+            for (size_t j = 0; j < N; ++j)
+            {
+                float c = C[i * ldc + j], r = R[i * ldc + j];
+                if (!(::fabs(c - r) <= 1.0e-4f * std::max(1.0f, ::fabs(r))))
+                {
+                    std::cout << "GEMM " << (transA ? "T" : "N") << (transB ? "T" : "N") << " M=" << M << " N=" << N << " K=" << K;
+                    std::cout << " beta=" << beta << (packed ? " packed" : "") << ": C[" << i << "][" << j << "] = " << c << " != " << r << " !" << std::endl;
+                    return false;
+                }
+            }
+        return true;
+    }
+
+    template<class T> inline T Gemm8iRandom(size_t i, size_t seed)
+    {
+        size_t value = (i * 2654435761u + seed * 40503u) >> 7;
+        return std::is_signed<T>::value ? T(int(value % 256) - 128) : T(value % 128);
+    }
+
+    template<class TA, class TB> inline bool TestGemm8i(size_t M, size_t N, size_t K)
+    {
+        std::vector<TA> A(M * K);
+        std::vector<TB> B(K * N);
+        for (size_t i = 0; i < A.size(); ++i)
+            A[i] = Gemm8iRandom<TA>(i, 1);
+        for (size_t i = 0; i < B.size(); ++i)
+            B[i] = Gemm8iRandom<TB>(i, 2);
+        std::vector<int32_t> C(M * N), R(M * N);
+        Synet::CpuGemmNN(M, N, K, A.data(), K, B.data(), N, R.data(), N);
+        Synet::Ints order;
+        Synet::CpuGemm8iOrder(1, K, false, order);
+        size_t Q = order.size() / 4;
+        std::vector<TA> pA(M * order.size());
+        std::vector<TB> pB(Synet::CpuGemm8iPackedSizeB(N, Q));
+        Synet::CpuGemm8iPackA(M, order, A.data(), K, pA.data());
+        Synet::CpuGemm8iPackB(N, order, B.data(), N, pB.data());
+        Synet::CpuGemm8i(M, N, Q, pA.data(), order.size(), pB.data(), C.data(), N);
+        for (size_t i = 0; i < C.size(); ++i)
+        {
+            if (C[i] != R[i])
+            {
+                std::cout << "GEMM 8i M=" << M << " N=" << N << " K=" << K << ": C[" << i / N << "][" << i % N << "] = " << C[i] << " != " << R[i] << " !" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool TestGemm()
+    {
+        const GemmSize sizes[] = { { 1, 1, 1 }, { 5, 7, 3 }, { 17, 33, 65 }, { 64, 196, 147 }, { 130, 67, 300 }, { 3, 515, 9 } };
+        bool result = true;
+        for (size_t threads = 1; threads <= 4; threads *= 4)
+        {
+            Synet::SetThreadNumber(threads);
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+            {
+                size_t M = sizes[s].M, N = sizes[s].N, K = sizes[s].K;
+                for (int t = 0; t < 4; ++t)
+                {
+                    result = result && TestGemm32f(t & 1, t & 2, M, N, K, 0.0f, false);
+                    result = result && TestGemm32f(t & 1, t & 2, M, N, K, 1.0f, false);
+                    result = result && TestGemm32f(t & 1, t & 2, M, N, K, 0.0f, true);
+                }
+                result = result && TestGemm8i<uint8_t, int8_t>(M, N, K);
+                result = result && TestGemm8i<int8_t, uint8_t>(M, N, K);
+            }
+        }
+        Synet::SetThreadNumber(1);
+        return result;
+    }
+}
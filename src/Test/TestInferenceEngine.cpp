@@ -23,6 +23,7 @@
 */
 
 #include "Test/TestCompare.h"
+#include "Test/TestGemm.h"
 
 #include "Synet/Converters/InferenceEngine.h"
 
@@ -482,6 +483,8 @@ int main(int argc, char* argv[])
         options.result = Test::ConvertTextWeightToBinary(options.textWeight, options.otherWeight);
         std::cout << (options.result ? "OK." : " Conversion finished with errors!") << std::endl;
     }
+    else if (options.mode == "gemm")
+        options.result = Test::BenchmarkGemm(options.workThreads);
     else
         std::cout << "Unknown mode : " << options.mode << std::endl;
 
@@ -0,0 +1,197 @@
+/*
+* Tests for Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Network.h"
+
+namespace Test
+{
+    typedef Synet::Network<float> UnitNet;
+
+    inline Synet::LayerParam UnitLayer(Synet::LayerType type, const Synet::String & name, const Synet::Strings & src)
+    {
+        Synet::LayerParam layer;
+        layer.type() = type;
+        layer.name() = name;
+        layer.src() = src;
+        layer.dst().push_back(name);
+        return layer;
+    }
+
+    inline Synet::LayerParam UnitInput(const Synet::String & name, const Synet::Shape & shape)
+    {
+        Synet::LayerParam layer = UnitLayer(Synet::LayerTypeInput, name, Synet::Strings());
+        layer.input().shape().resize(1);
+        layer.input().shape()[0].dim() = shape;
+        return layer;
+    }
+
+    inline void UnitWeight(Synet::LayerParam & layer, const Synet::Shape & shape, Synet::Floats & bin, float scale)
+    {
+        Synet::WeightParam weight;
+        weight.dim() = shape;
+        weight.offset() = bin.size() * sizeof(float);
+        size_t size = 1;
+        for (size_t i = 0; i < shape.size(); ++i)
+            size *= shape[i];
+        weight.size() = size * sizeof(float);
+        for (size_t i = 0; i < size; ++i)
+            bin.push_back(scale * (float((i * 7 + bin.size() * 3) % 17) / 8.0f - 1.0f));
+        layer.weight().push_back(weight);
+    }
+
+    inline bool UnitLoad(const Synet::NetworkParam & param, const Synet::Floats & bin, UnitNet & net)
+    {
+        Synet::NetworkParamHolder holder;
+        holder() = param;
+        std::stringstream model;
+        if (!holder.Save(model, false))
+            return false;
+        Synet::String data = model.str();
+        return net.Load(data.c_str(), data.size(), (const char*)bin.data(), bin.size() * sizeof(float));
+    }
+
+    inline void UnitSetInput(UnitNet & net, float shift = 0.0f)
+    {
+        for (size_t i = 0; i < net.Src().size(); ++i)
+        {
+            Synet::Tensor<float> & src = *net.Src()[i];
+            for (size_t j = 0; j < src.Size(); ++j)
+                src.CpuData()[j] = float((j * 13) % 23) / 11.0f - 1.0f + shift;
+        }
+    }
+
+    inline Synet::Floats UnitForward(UnitNet & net, float shift = 0.0f)
+    {
+        UnitSetInput(net, shift);
+        net.Forward();
+        Synet::Floats dst;
+        for (size_t i = 0; i < net.Dst().size(); ++i)
+            dst.insert(dst.end(), net.Dst()[i]->CpuData(), net.Dst()[i]->CpuData() + net.Dst()[i]->Size());
+        return dst;
+    }
+
+    inline bool UnitCompare(const Synet::Floats & a, const Synet::Floats & b, float threshold, const char * name)
+    {
+        if (a.size() != b.size())
+        {
+            std::cout << name << ": output size " << a.size() << " != " << b.size() << " !" << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (!(::fabs(a[i] - b[i]) <= threshold * std::max(1.0f, ::fabs(b[i]))))
+            {
+                std::cout << name << ": dst[" << i << "] = " << a[i] << " != " << b[i] << " !" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool UnitSetAlgorithm(UnitNet & net, const Synet::String & key, int algorithm, const Synet::String & path)
+    {
+        std::ofstream ofs(path.c_str());
+        ofs << Synet::TuningCache::CpuId() << "\t" << Synet::ValueToString(Synet::LayerTypeConvolution) << "\t" << key << "\t" << algorithm << std::endl;
+        ofs.close();
+        net.SetTuning(true, path);
+        net.SetTuning(false);
+        return std::remove(path.c_str()) == 0;
+    }
+
+    inline Synet::NetworkParam UnitConvolution3x3(const Synet::Shape & shape, Synet::Floats & bin)
+    {
+        Synet::NetworkParam network;
+        network.layers().push_back(UnitInput("data", shape));
+        Synet::LayerParam conv = UnitLayer(Synet::LayerTypeConvolution, "conv", Synet::Strings({ "data" }));
+        conv.convolution().outputNum() = (uint32_t)shape[1];
+        conv.convolution().kernel() = Synet::Shape({ 3, 3 });
+        conv.convolution().pad() = Synet::Shape({ 1, 1, 1, 1 });
+        conv.convolution().stride() = Synet::Shape({ 1, 1 });
+        UnitWeight(conv, Synet::Shape({ shape[1], shape[1], 3, 3 }), bin, 0.1f);
+        UnitWeight(conv, Synet::Shape({ shape[1] }), bin, 1.0f);
+        network.layers().push_back(conv);
+        return network;
+    }
+
+    inline bool TestNetworkShareTuning()
+    {
+        Synet::Floats bin;
+        Synet::NetworkParam network = UnitConvolution3x3(Synet::Shape({ 1, 16, 16, 16 }), bin);
+        const Synet::String key = "n=1 i=16x16x16 o=16 k=3x3 s=1x1 d=1x1 p=1,1,1,1 g=1 f=nchw", path = "test_unit_tuning.txt";
+        UnitNet owner, context;
+        if (!UnitLoad(network, bin, owner) || !context.Share(owner))
+            return false;
+        Synet::Floats reference = UnitForward(owner), ownerDst, contextDst;
+        if (!UnitSetAlgorithm(owner, key, 1, path) || !UnitCompare(ownerDst = UnitForward(owner), reference, 0.001f, "Tuned owner"))
+            return false;
+        if (!UnitCompare(UnitForward(context), reference, 0.0f, "Context after owner tuning"))
+            return false;
+        if (!UnitSetAlgorithm(context, key, 0, path) || !UnitCompare(contextDst = UnitForward(context), reference, 0.001f, "Tuned context"))
+            return false;
+        if (!UnitCompare(UnitForward(owner), ownerDst, 0.0f, "Owner after context tuning"))
+            return false;
+        if (!UnitSetAlgorithm(owner, key, 2, path) || !UnitCompare(UnitForward(owner), reference, 0.0f, "Retuned owner"))
+            return false;
+        return UnitCompare(UnitForward(context), contextDst, 0.0f, "Context after owner retuning");
+    }
+
+    inline bool TestNetworkCompactWeight()
+    {
+        Synet::Floats bin;
+        Synet::NetworkParam network = UnitConvolution3x3(Synet::Shape({ 1, 16, 8, 8 }), bin);
+        UnitNet compact, tuned, owner, context;
+        if (!UnitLoad(network, bin, compact) || !UnitLoad(network, bin, tuned) || !UnitLoad(network, bin, owner) || !context.Share(owner))
+            return false;
+        size_t memory = compact.MemoryUsage();
+        compact.CompactWeight();
+        if (compact.MemoryUsage() + 16 * 16 * 9 * sizeof(float) > memory)
+        {
+            std::cout << "CompactWeight doesn't release source weights !" << std::endl;
+            return false;
+        }
+        tuned.SetTuning(true);
+        memory = tuned.MemoryUsage();
+        tuned.CompactWeight();
+        if (tuned.MemoryUsage() != memory)
+        {
+            std::cout << "CompactWeight releases source weights of network with tuning !" << std::endl;
+            return false;
+        }
+        memory = owner.MemoryUsage();
+        owner.CompactWeight();
+        if (owner.MemoryUsage() != memory)
+        {
+            std::cout << "CompactWeight releases source weights of shared network !" << std::endl;
+            return false;
+        }
+        if (!compact.Reshape(32, 32, 1) || !tuned.Reshape(32, 32, 1) || !owner.Reshape(32, 32, 1))
+            return false;
+        Synet::Floats reference = UnitForward(owner);
+        if (!UnitCompare(UnitForward(compact), reference, 0.001f, "Reshaped compact network"))
+            return false;
+        return UnitCompare(UnitForward(tuned), reference, 0.001f, "Reshaped tuned network");
+    }
+}
@@ -0,0 +1,269 @@
+/*
+* Tests for Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "TestNetwork.h"
+
+#include "Synet/Converters/Optimizer.h"
+
+namespace Test
+{
+    inline bool UnitOptimize(const Synet::NetworkParam & src, const Synet::Floats & bin, bool foldShapes, Synet::NetworkParam & dst, Synet::Floats & dstBin)
+    {
+        dst = src;
+        dstBin = bin;
+        Synet::Optimizer optimizer(foldShapes);
+        return optimizer.Run(dst, dstBin);
+    }
+
+    inline size_t UnitCount(const Synet::NetworkParam & network, Synet::LayerType type)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < network.layers().size(); ++i)
+            if (network.layers()[i].type() == type)
+                count++;
+        return count;
+    }
+
+    inline Synet::LayerParam UnitConvolution(const Synet::String & name, const Synet::String & src, size_t srcC, size_t dstC, size_t kernel, size_t group,
+        bool trans, Synet::ActivationFunctionType activation, Synet::Floats & bin)
+    {
+        Synet::LayerParam conv = UnitLayer(Synet::LayerTypeConvolution, name, Synet::Strings({ src }));
+        conv.convolution().outputNum() = (uint32_t)dstC;
+        conv.convolution().kernel() = Synet::Shape({ kernel, kernel });
+        conv.convolution().pad() = Synet::Shape({ kernel / 2, kernel / 2, kernel / 2, kernel / 2 });
+        conv.convolution().stride() = Synet::Shape({ 1, 1 });
+        conv.convolution().group() = (uint32_t)group;
+        conv.convolution().activationType() = activation;
+        UnitWeight(conv, trans ? Synet::Shape({ kernel, kernel, srcC / group, dstC }) : Synet::Shape({ dstC, srcC / group, kernel, kernel }), bin, 0.1f);
+        if (trans)
+            conv.weight()[0].format() = Synet::TensorFormatNhwc;
+        UnitWeight(conv, Synet::Shape({ dstC }), bin, 0.5f);
+        return conv;
+    }
+
+    inline Synet::NetworkParam UnitResidual(const std::vector<Synet::LayerParam> & convs, bool trans)
+    {
+        Synet::NetworkParam network;
+        network.layers().push_back(UnitInput("data", trans ? Synet::Shape({ 1, 8, 8, 16 }) : Synet::Shape({ 1, 16, 8, 8 })));
+        if (trans)
+            network.layers()[0].input().shape()[0].format() = Synet::TensorFormatNhwc;
+        network.layers().insert(network.layers().end(), convs.begin(), convs.end());
+        network.layers().push_back(UnitLayer(Synet::LayerTypeEltwise, "sum", Synet::Strings({ "data", convs.back().name() })));
+        network.layers().push_back(UnitLayer(Synet::LayerTypeRelu, "relu", Synet::Strings({ "sum" })));
+        return network;
+    }
+
+    inline bool TestOptimizerFoldShapes()
+    {
+        Synet::NetworkParam network;
+        Synet::Floats bin;
+        network.layers().push_back(UnitInput("data", Synet::Shape({ 1, 3, 16, 16 })));
+        Synet::LayerParam pool = UnitLayer(Synet::LayerTypePooling, "pool", Synet::Strings({ "data" }));
+        pool.pooling().method() = Synet::PoolingMethodTypeMax;
+        pool.pooling().kernel() = Synet::Shape({ 2, 2 });
+        pool.pooling().stride() = Synet::Shape({ 2, 2 });
+        network.layers().push_back(pool);
+        Synet::LayerParam prior = UnitLayer(Synet::LayerTypePriorBox, "prior", Synet::Strings({ "pool", "data" }));
+        prior.priorBox().minSize() = Synet::Floats({ 4.0f });
+        prior.priorBox().aspectRatio() = Synet::Floats({ 2.0f });
+        prior.priorBox().variance() = Synet::Floats({ 0.1f, 0.1f, 0.2f, 0.2f });
+        network.layers().push_back(prior);
+
+        Synet::NetworkParam folded, kept;
+        Synet::Floats foldedBin, keptBin;
+        if (!UnitOptimize(network, bin, true, folded, foldedBin) || !UnitOptimize(network, bin, false, kept, keptBin))
+            return false;
+        if (UnitCount(folded, Synet::LayerTypePriorBox) != 0 || !folded.fixedShape())
+        {
+            std::cout << "PriorBox is not folded by default Optimizer !" << std::endl;
+            return false;
+        }
+        if (UnitCount(kept, Synet::LayerTypePriorBox) != 1 || kept.fixedShape())
+        {
+            std::cout << "PriorBox is folded with foldShapes = false !" << std::endl;
+            return false;
+        }
+        UnitNet original, foldedNet, keptNet;
+        if (!UnitLoad(network, bin, original) || !UnitLoad(folded, foldedBin, foldedNet) || !UnitLoad(kept, keptBin, keptNet))
+            return false;
+        if (!UnitCompare(UnitForward(foldedNet), UnitForward(original), 0.0f, "Folded PriorBox"))
+            return false;
+        if (foldedNet.Resizable() || foldedNet.Reshape(32, 32, 1) || foldedNet.Reshape(16, 16, 2))
+        {
+            std::cout << "Network with folded shape layers allows reshape !" << std::endl;
+            return false;
+        }
+        if (!foldedNet.Reshape(16, 16, 1) || !keptNet.Reshape(32, 32, 1) || !original.Reshape(32, 32, 1))
+            return false;
+        return UnitCompare(UnitForward(keptNet), UnitForward(original), 0.0f, "Reshaped PriorBox");
+    }
+
+    inline bool TestOptimizerRemoveStub()
+    {
+        for (int inplace = 0; inplace < 2; ++inplace)
+        {
+            const char * reused = inplace ? "x" : "y";
+            Synet::NetworkParam network;
+            Synet::Floats bin;
+            network.layers().push_back(UnitInput("data", Synet::Shape({ 1, 2, 2, 2 })));
+            Synet::LayerParam scale = UnitLayer(Synet::LayerTypeScale, "x", Synet::Strings({ "data" }));
+            UnitWeight(scale, Synet::Shape({ 2 }), bin, 1.0f);
+            network.layers().push_back(scale);
+            network.layers().push_back(UnitLayer(Synet::LayerTypeDropout, "y", Synet::Strings({ "x" })));
+            Synet::LayerParam relu = UnitLayer(Synet::LayerTypeRelu, "relu", Synet::Strings({ reused }));
+            relu.dst()[0] = reused;
+            network.layers().push_back(relu);
+            network.layers().push_back(UnitLayer(Synet::LayerTypeEltwise, "sum", Synet::Strings({ "y", "x" })));
+
+            Synet::NetworkParam optimized;
+            Synet::Floats optimizedBin;
+            if (!UnitOptimize(network, bin, true, optimized, optimizedBin))
+                return false;
+            if (UnitCount(optimized, Synet::LayerTypeDropout) != 0)
+            {
+                std::cout << "Dropout is not removed by Optimizer !" << std::endl;
+                return false;
+            }
+            UnitNet net;
+            if (!UnitLoad(optimized, optimizedBin, net))
+                return false;
+            Synet::Floats dst = UnitForward(net);
+            UnitSetInput(net);
+            Synet::Floats ref(net.Src()[0]->Size());
+            for (size_t i = 0; i < ref.size(); ++i)
+            {
+                float x = net.Src()[0]->CpuData()[i] * bin[i / 4];
+                ref[i] = std::max(x, 0.0f) + x;
+            }
+            if (!UnitCompare(dst, ref, 0.0f, inplace ? "Stub with in-place source" : "Stub with in-place destination"))
+                return false;
+        }
+        return true;
+    }
+    inline bool TestOptimizerMergeResidual()
+    {
+        const Synet::String key = "n=1 i=16x8x8 o=16 k=3x3 s=1x1 d=1x1 p=1,1,1,1 g=1 f=nchw", path = "TestOptimizerMergeResidual.txt";
+        for (int trans = 0; trans < 2; ++trans)
+        {
+            Synet::Floats bin;
+            Synet::NetworkParam network = UnitResidual({ UnitConvolution("conv", "data", 16, 16, 3, 1, trans != 0, Synet::ActivationFunctionTypeIdentity, bin) }, trans != 0);
+            Synet::NetworkParam optimized;
+            Synet::Floats optimizedBin;
+            if (!UnitOptimize(network, bin, true, optimized, optimizedBin))
+                return false;
+            if (UnitCount(optimized, Synet::LayerTypeEltwise) != 0 || UnitCount(optimized, Synet::LayerTypeRelu) != 0)
+            {
+                std::cout << "Residual and activation are not merged into Convolution !" << std::endl;
+                return false;
+            }
+            UnitNet original, merged;
+            if (!UnitLoad(network, bin, original) || !UnitLoad(optimized, optimizedBin, merged))
+                return false;
+            Synet::Floats reference = UnitForward(original);
+            for (int algorithm = 0; algorithm < (trans ? 1 : 3); ++algorithm)
+            {
+                if (!trans && !UnitSetAlgorithm(merged, key, algorithm, path))
+                    return false;
+                if (!UnitCompare(UnitForward(merged), reference, 0.001f, "Convolution with residual and activation"))
+                    return false;
+            }
+        }
+
+        Synet::Floats bin;
+        Synet::NetworkParam network = UnitResidual({ UnitConvolution("conv0", "data", 16, 32, 1, 1, true, Synet::ActivationFunctionTypeRelu, bin),
+            UnitConvolution("conv1", "conv0", 32, 32, 3, 32, true, Synet::ActivationFunctionTypeRelu, bin),
+            UnitConvolution("conv2", "conv1", 32, 16, 1, 1, true, Synet::ActivationFunctionTypeIdentity, bin) }, true);
+        Synet::NetworkParam optimized;
+        Synet::Floats optimizedBin;
+        if (!UnitOptimize(network, bin, true, optimized, optimizedBin))
+            return false;
+        if (UnitCount(optimized, Synet::LayerTypeMergedConvolution) != 1 || UnitCount(optimized, Synet::LayerTypeConvolution) != 0)
+        {
+            std::cout << "Residual block with activation after sum is not merged into MergedConvolution !" << std::endl;
+            return false;
+        }
+        UnitNet original, merged;
+        if (!UnitLoad(network, bin, original) || !UnitLoad(optimized, optimizedBin, merged))
+            return false;
+        return UnitCompare(UnitForward(merged), UnitForward(original), 0.001f, "MergedConvolution with residual and activation");
+    }
+
+    inline Synet::LayerParam UnitYolo(const Synet::String & name, const Synet::String & src)
+    {
+        Synet::LayerParam yolo = UnitLayer(Synet::LayerTypeYolo, name, Synet::Strings({ src }));
+        yolo.yolo().classes() = 3;
+        yolo.yolo().num() = 2;
+        yolo.yolo().total() = 2;
+        yolo.yolo().mask() = Synet::Index({ 0, 1 });
+        yolo.yolo().anchors() = Synet::Floats({ 10.0f, 14.0f, 23.0f, 27.0f });
+        return yolo;
+    }
+
+    inline bool TestOptimizerYoloFused()
+    {
+        Synet::NetworkParam network;
+        Synet::Floats bin;
+        network.layers().push_back(UnitInput("data", Synet::Shape({ 1, 16, 6, 5 })));
+        network.layers().push_back(UnitConvolution("conv", "data", 16, 16, 1, 1, false, Synet::ActivationFunctionTypeIdentity, bin));
+        network.layers().push_back(UnitYolo("yolo", "conv"));
+        network.layers().push_back(UnitYolo("direct", "data"));
+
+        Synet::NetworkParam optimized;
+        Synet::Floats optimizedBin;
+        if (!UnitOptimize(network, bin, true, optimized, optimizedBin))
+            return false;
+        for (size_t i = 0; i < optimized.layers().size(); ++i)
+        {
+            const Synet::LayerParam & layer = optimized.layers()[i];
+            if (layer.type() == Synet::LayerTypeYolo && layer.yolo().fused() != (layer.name() == "yolo"))
+            {
+                std::cout << "Yolo layer " << layer.name() << (layer.yolo().fused() ? " is" : " is not") << " fused by Optimizer !" << std::endl;
+                return false;
+            }
+        }
+        UnitNet original, fused;
+        if (!UnitLoad(network, bin, original) || !UnitLoad(optimized, optimizedBin, fused))
+            return false;
+        Synet::Floats reference = UnitForward(original);
+        if (!UnitCompare(UnitForward(fused), reference, 0.0f, "Fused Yolo") || !UnitCompare(UnitForward(fused), reference, 0.0f, "Fused Yolo after second Forward"))
+            return false;
+        UnitNet::Regions a = original.GetRegions(320, 240, 0.3f, 0.5f), b = fused.GetRegions(320, 240, 0.3f, 0.5f);
+        if (a.empty() || a.size() != b.size())
+        {
+            std::cout << "Fused Yolo: " << b.size() << " regions != " << a.size() << " !" << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].w != b[i].w || a[i].h != b[i].h || a[i].prob != b[i].prob || a[i].id != b[i].id)
+            {
+                std::cout << "Fused Yolo: region " << i << " differs !" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
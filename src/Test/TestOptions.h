@@ -46,6 +46,7 @@ namespace Test
         String outputDirectory;
         size_t repeatNumber;
         size_t workThreads;
+        size_t interThreads;
         size_t testThreads;
         float threshold;
         String logName;
@@ -80,6 +81,7 @@ namespace Test
             outputDirectory = GetArg("-od", "./output");
             repeatNumber = FromString<size_t>(GetArg("-rn", "1"));
             workThreads = FromString<size_t>(GetArg("-wt", "1"));
+            interThreads = FromString<size_t>(GetArg("-it", "1"));
             testThreads = FromString<size_t>(GetArg("-tt", "0"));
             threshold = FromString<float>(GetArg("-t", "0.001"));
             logName = GetArg("-ln", "", false);
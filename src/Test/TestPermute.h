@@ -0,0 +1,89 @@
+/*
+* Tests for Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Utils/Permute.h"
+
+namespace Test
+{
+    template<class T> inline bool TestPermute(const Synet::Shape & shape, const Synet::Shape & order)
+    {
+        size_t size = 1, count = shape.size();
+        for (size_t i = 0; i < count; ++i)
+            size *= shape[i];
+        std::vector<T> src(size), dst(size, T(-1)), ref(size);
+        for (size_t i = 0; i < size; ++i)
+            src[i] = T(i);
+        Synet::Shape index(count, 0);
+        for (size_t d = 0; d < size; ++d)
+        {
+            size_t s = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                size_t stride = 1;
+                for (size_t j = order[i] + 1; j < count; ++j)
+                    stride *= shape[j];
+                s += index[i] * stride;
+            }
+            ref[d] = src[s];
+            for (ptrdiff_t i = count - 1; i >= 0 && ++index[i] == shape[order[i]]; --i)
+                index[i] = 0;
+        }
+        Synet::CpuPermute(src.data(), shape, order, dst.data());
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (dst[i] != ref[i])
+            {
+                std::cout << "Permute {";
+                for (size_t j = 0; j < count; ++j)
+                    std::cout << " " << shape[j];
+                std::cout << " } by {";
+                for (size_t j = 0; j < count; ++j)
+                    std::cout << " " << order[j];
+                std::cout << " }: dst[" << i << "] = " << dst[i] << " != " << ref[i] << " !" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool TestPermute()
+    {
+        const Synet::Shape shapes[] = { { 1, 3, 17, 23 }, { 2, 37, 9, 65 }, { 1, 64, 1, 33 }, { 3, 5, 7, 11, 13 }, { 2, 3, 4, 5, 6, 7 } };
+        bool result = true;
+        for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s)
+        {
+            Synet::Shape order(shapes[s].size());
+            for (size_t i = 0; i < order.size(); ++i)
+                order[i] = i;
+            do
+            {
+                result = result && TestPermute<float>(shapes[s], order);
+                result = result && TestPermute<int32_t>(shapes[s], order);
+            } while (std::next_permutation(order.begin(), order.end()));
+        }
+        return result;
+    }
+}
@@ -126,30 +126,19 @@ namespace Test
             TEST_PERF_FUNC();
             _regionThreshold = options.regionThreshold;
             Synet::SetThreadNumber(options.workThreads);
-            if (Load(model, weight))
-            {
-                _trans = _net.Format() == Synet::TensorFormatNhwc;
-                _sort = param.output().empty();
-                if (param.input().size() || param.output().size())
-                {
-                    if (!Reshape(param, options.batchSize))
-                        return false;
-                }
-                else if (_net.Src().size() == 1)
-                {
-                    const Shape & shape = _net.NchwShape();
-                    if (shape.size() == 4 && shape[0] != options.batchSize)
-                    {
-                        if (!_net.Reshape(shape[3], shape[2], options.batchSize))
-                            return false;
-                    }
-                }
-                _net.CompactWeight();
-                _lower = param.lower();
-                _upper = param.upper();
-                return true;
-            }
-            return false;
+            return Load(model, weight) && Init(options, param);
+        }
+
+        bool Init(const SynetNetwork & origin, const Options & options, const TestParam & param)
+        {
+            TEST_PERF_FUNC();
+            _regionThreshold = options.regionThreshold;
+            return _net.Share(origin._net) && Init(options, param);
+        }
+
+        void CompactWeight()
+        {
+            _net.CompactWeight();
         }
 
         virtual const Vectors & Predict(const Vectors & x)
@@ -185,6 +174,30 @@ namespace Test
         bool _trans, _sort;
         Floats _lower, _upper;
 
+        bool Init(const Options & options, const TestParam & param)
+        {
+            _net.SetInterOpThreads(options.interThreads);
+            _trans = _net.Format() == Synet::TensorFormatNhwc;
+            _sort = param.output().empty();
+            if (param.input().size() || param.output().size())
+            {
+                if (!Reshape(param, options.batchSize))
+                    return false;
+            }
+            else if (_net.Src().size() == 1)
+            {
+                const Shape & shape = _net.NchwShape();
+                if (shape.size() == 4 && shape[0] != options.batchSize)
+                {
+                    if (!_net.Reshape(shape[3], shape[2], options.batchSize))
+                        return false;
+                }
+            }
+            _lower = param.lower();
+            _upper = param.upper();
+            return true;
+        }
+
         bool Load(const String & model, const String & weight)
         {
 #ifdef SYNET_TEST_MEMORY_LOAD
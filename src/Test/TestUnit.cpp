@@ -0,0 +1,71 @@
+/*
+* Tests for Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "TestGemm.h"
+#include "TestVectorMath.h"
+#include "TestPermute.h"
+#include "TestOptimizer.h"
+#include "TestBatcher.h"
+
+namespace Test
+{
+    typedef bool(*UnitTestPtr)();
+
+    struct UnitTest
+    {
+        const char * name;
+        UnitTestPtr test;
+    };
+
+    const UnitTest UNIT_TESTS[] =
+    {
+        { "Gemm", TestGemm },
+        { "VectorMath", TestVectorMath },
+        { "Permute", TestPermute },
+        { "NetworkShareTuning", TestNetworkShareTuning },
+        { "NetworkCompactWeight", TestNetworkCompactWeight },
+        { "OptimizerFoldShapes", TestOptimizerFoldShapes },
+        { "OptimizerRemoveStub", TestOptimizerRemoveStub },
+        { "OptimizerMergeResidual", TestOptimizerMergeResidual },
+        { "OptimizerYoloFused", TestOptimizerYoloFused },
+        { "Batcher", TestBatcher },
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    std::string filter = argc > 1 ? argv[1] : "";
+    size_t failed = 0;
+    for (size_t i = 0; i < sizeof(Test::UNIT_TESTS) / sizeof(Test::UNIT_TESTS[0]); ++i)
+    {
+        const Test::UnitTest & test = Test::UNIT_TESTS[i];
+        if (test.name != filter && !filter.empty())
+            continue;
+        bool result = test.test();
+        std::cout << test.name << ": " << (result ? "OK" : "FAILED") << std::endl;
+        if (!result)
+            failed++;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+/*
+* Tests for Synet Framework (http://github.com/ermig1979/Synet).
+*
+* Copyright (c) 2018-2019 Yermalayeu Ihar.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "Synet/Utils/VectorMath.h"
+
+namespace Test
+{
+    inline double VectorMathUlp(float value, double reference)
+    {
+        if (std::isnan(reference) || std::isinf(reference))
+            return (std::isnan(reference) ? std::isnan(value) : value == reference) ? 0.0 : INFINITY;
+        double unit = ::ldexp(1.0, std::max(std::ilogb(std::max(::fabs(reference), double(FLT_MIN))), FLT_MIN_EXP - 1) - 23);
+        return ::fabs(value - reference) / unit;
+    }
+
+    template<class Vector, class Scalar, class Reference> inline bool TestVectorMath(const char * name, float lo, float hi, double bound,
+        Vector vector, Scalar scalar, Reference reference)
+    {
+        const size_t size = 1000003;
+        std::vector<float> src(size), dst(size);
+        for (size_t i = 0; i < size; ++i)
+            src[i] = lo + (hi - lo) * float(i) / float(size - 1);
+        vector(src.data(), size, dst.data());
+        double error = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            double ref = reference(double(src[i]));
+            error = std::max(error, std::max(VectorMathUlp(dst[i], ref), VectorMathUlp(scalar(src[i]), ref)));
+        }
+        if (error > bound)
+        {
+            std::cout << name << " error " << error << " ULP on [" << lo << ", " << hi << "] exceeds " << bound << " ULP !" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    inline bool TestVectorMathExpLimits()
+    {
+        const float values[] = { 0.0f, 88.7f, 88.7228f, 88.73f, 89.0f, 100.0f, INFINITY, -87.33f, -87.34f, -100.0f, -INFINITY, NAN };
+        const size_t count = sizeof(values) / sizeof(values[0]), size = count * 16;
+        std::vector<float> src(size), dst(size);
+        for (size_t i = 0; i < size; ++i)
+            src[i] = values[i % count];
+        Synet::VectorExp(src.data(), size, dst.data());
+        for (size_t i = 0; i < size; ++i)
+        {
+            double ref = ::exp(double(src[i]));
+            if (ref < FLT_MIN)
+                ref = 0.0;
+            else if (ref > FLT_MAX)
+                ref = INFINITY;
+            if (std::max(VectorMathUlp(dst[i], ref), VectorMathUlp(Synet::ScalarExp(src[i]), ref)) > 1.5)
+            {
+                std::cout << "Exp(" << src[i] << ") = " << dst[i] << " (scalar " << Synet::ScalarExp(src[i]) << ") != " << ref << " !" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool TestVectorMath()
+    {
+        bool result = true;
+        result = result && TestVectorMath("Exp", -87.3f, 88.7f, 1.3, Synet::VectorExp, Synet::ScalarExp, [](double x) { return ::exp(x); });
+        result = result && TestVectorMathExpLimits();
+        result = result && TestVectorMath("Log", 1.0e-30f, 1.0e30f, 0.85, Synet::VectorLog, Synet::ScalarLog, [](double x) { return ::log(x); });
+        result = result && TestVectorMath("Log", 0.5f, 2.0f, 0.85, Synet::VectorLog, Synet::ScalarLog, [](double x) { return ::log(x); });
+        result = result && TestVectorMath("Sigmoid", -80.0f, 80.0f, 3.2, Synet::VectorSigmoid, Synet::ScalarSigmoid, [](double x) { return 1.0 / (1.0 + ::exp(-x)); });
+        result = result && TestVectorMath("Tanh", -10.0f, 10.0f, 1.4, Synet::VectorTanh, Synet::ScalarTanh, [](double x) { return ::tanh(x); });
+        result = result && TestVectorMath("Pow", 1.0e-30f, 3.0e38f, 113.0, [](const float * src, size_t size, float * dst) { Synet::VectorPow(src, size, -0.75f, dst); },
+            [](float x) { float y; Synet::VectorPow(&x, 1, -0.75f, &y); return y; }, [](double x) { return ::pow(x, -0.75); });
+        return result;
+    }
+}
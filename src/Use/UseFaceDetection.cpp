@@ -37,7 +37,7 @@ typedef std::vector<Region> Regions;
 int main(int argc, char* argv[])
 {
     Synet::ConvertInferenceEngineToSynet("ie_fd.xml", "ie_fd.bin", 
-		true, "synet.xml", "synet.bin");
+		true, "synet.xml", "synet.bin", false);
 
     Net net;
     net.Load("synet.xml", "synet.bin");